@@ -1,5 +1,13 @@
-'/home/mansen/my workspace/vulkan/1.3.280.1/x86_64/bin/glslc' triangle.frag -o triangle_frag.spv
-'/home/mansen/my workspace/vulkan/1.3.280.1/x86_64/bin/glslc' triangle.vert -o triangle_vert.spv
+#!/bin/sh
+# regenerates the prebuilt .spv files the build falls back to when glslc isn't installed, and validates them.
+# uses $VULKAN_SDK/bin/glslc and spirv-val if set, the ones from PATH otherwise
+cd "$(dirname "$0")" || exit 1
+GLSLC="${VULKAN_SDK:+$VULKAN_SDK/bin/}glslc"
+SPIRV_VAL="${VULKAN_SDK:+$VULKAN_SDK/bin/}spirv-val"
 
-'/home/mansen/my workspace/vulkan/1.3.280.1/x86_64/bin/glslc' triangle_no_input.frag -o triangle_no_input_frag.spv
-'/home/mansen/my workspace/vulkan/1.3.280.1/x86_64/bin/glslc' triangle_no_input.vert -o triangle_no_input_vert.spv
\ No newline at end of file
+for shader in *.vert *.frag *.comp; do
+    [ -e "$shader" ] || continue
+    spv="${shader%.*}_${shader##*.}.spv"
+    "$GLSLC" "$shader" -o "$spv" || exit 1
+    "$SPIRV_VAL" --target-env vulkan1.0 "$spv" || exit 1
+done
@@ -0,0 +1,68 @@
+# Writes every SPIR-V module in SPV_FILES (a |-separated list) into OUTPUT as aligned constexpr uint32_t arrays,
+# plus a table to look them up by file name.
+# usage : cmake -DSPV_FILES="a.spv|b.spv" -DOUTPUT=embedded_shaders.h -P embed_spirv.cmake
+
+set(header "#pragma once\n//generated by shaders/embed_spirv.cmake, do not edit\n\n")
+string(APPEND header "#include <cstdint>\n#include <cstddef>\n#include <string_view>\n\n")
+string(APPEND header "namespace embedded_shaders\n{\n")
+
+string(REPLACE "|" ";" SPV_FILES "${SPV_FILES}")
+set(table "")
+foreach(spv_file ${SPV_FILES})
+    get_filename_component(file_name ${spv_file} NAME)
+    string(MAKE_C_IDENTIFIER ${file_name} identifier)
+
+    file(READ ${spv_file} bytes HEX)
+    string(LENGTH "${bytes}" hex_length)
+    math(EXPR remainder "${hex_length} % 8")
+    if(hex_length EQUAL 0 OR NOT remainder EQUAL 0)
+        message(FATAL_ERROR "${spv_file} is not a SPIR-V module")
+    endif()
+    # SPIR-V is little endian words, flip each group of 4 bytes into one literal
+    string(REGEX REPLACE "(..)(..)(..)(..)" "0x\\4\\3\\2\\1," words "${bytes}")
+    # cmake regexes have no {n}, spell out 8 words per line
+    string(REPEAT "0x........," 8 line_pattern)
+    string(REGEX REPLACE "(${line_pattern})" "\\1\n        " words "${words}")
+    string(STRIP "${words}" words)
+
+    string(APPEND header "    alignas(4) constexpr uint32_t ${identifier}[] = {\n        ${words}\n    };\n")
+    string(APPEND table "        {\"${file_name}\", ${identifier}, sizeof(${identifier})},\n")
+endforeach()
+
+string(APPEND header "
+    struct entry
+    {
+        std::string_view name;
+        const uint32_t*  code;
+        size_t           size;  //in bytes
+    };
+    constexpr entry table[] = {
+${table}    };
+
+    //nullptr if there is no shader of that name
+    constexpr const entry* find(std::string_view name)
+    {
+        for(const auto& e : table)
+            if(e.name == name)
+                return &e;
+        return nullptr;
+    }
+    //for names spelled out in the code, a shader that isn't embedded fails the build instead of the run
+    consteval const entry& get(std::string_view name)
+    {
+        const entry* e = find(name);
+        if(e == nullptr)
+            throw \"no embedded shader of that name\";
+        return *e;
+    }
+}
+")
+
+# only touch the file when it changed, so dependents don't rebuild for nothing
+if(EXISTS ${OUTPUT})
+    file(READ ${OUTPUT} previous)
+    if(previous STREQUAL header)
+        return()
+    endif()
+endif()
+file(WRITE ${OUTPUT} "${header}")
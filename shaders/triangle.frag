@@ -5,7 +5,10 @@ layout(location = 0) out vec4 out_color;
 //name doesn't have to match!! I love technology
 layout(location = 0) in  vec3 vertex_color;
 
+//baked into the pipeline, a variant per value
+layout(constant_id = 0) const float BRIGHTNESS = 1.0;
+
 void main()
 {
-    out_color = vec4(vertex_color, 1.0);
+    out_color = vec4(vertex_color * BRIGHTNESS, 1.0);
 }
\ No newline at end of file
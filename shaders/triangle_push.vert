@@ -0,0 +1,19 @@
+#version 450
+
+//triangle.vert, moved and scaled per draw through push constants. See --bench push
+layout(location = 0) in vec2   in_pos;
+layout(location = 1) in vec3 in_color;
+
+layout(location = 0) out vec3 vertex_color;
+
+layout(push_constant) uniform draw_t
+{
+    vec2 offset;
+    float scale;
+} draw;
+
+void main()
+{
+    gl_Position  = vec4(in_pos * draw.scale + draw.offset, 0.0, 1.0);
+    vertex_color = in_color;
+}
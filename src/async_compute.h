@@ -0,0 +1,123 @@
+#pragma once
+
+#include "vulkan_handle.h"
+#include "vulkan_data_getters.h"
+
+#include <functional>
+
+/*
+    Submits compute work on the device's compute queue so that it can overlap rasterization on the graphics queue.
+
+    Every submission signals a semaphore. Graphics work that consumes the results must wait on take_wait_semaphore()
+    before it is submitted; a result that nobody consumed is chained into the next compute submission instead,
+    so that a binary semaphore is never signalled twice.
+
+    When the compute family differs from the graphics family, resources touched by both queues must list both
+    families in their description (concurrent sharing), otherwise an ownership transfer is required.
+*/
+class async_compute_t
+{
+public:
+    typedef std::function<void (VkCommandBuffer)> record_fnc;
+
+    async_compute_t(const vk_handle::device& device, uint32_t max_in_flight,
+    VkPipelineStageFlags consumer_stage = VK_PIPELINE_STAGE_VERTEX_INPUT_BIT) :
+    command_pool(vk_handle::description::cmd_pool_desc{.parent = device, .queue_fam_index = device.description.compute_queue.fam_idx,
+    .flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT}),
+    command_buffers(vk_handle::description::cmd_buffers_desc{device, command_pool, max_in_flight, VK_COMMAND_BUFFER_LEVEL_PRIMARY}),
+    consumer_stage(consumer_stage), device(device)
+    {
+        slots.reserve(max_in_flight);
+        for(size_t i = 0; i < max_in_flight; ++i)
+            slots.emplace_back(device);
+        queue = vk_handle::data_getters::device::queue_handle(device, device.description.compute_queue);
+        dedicated_family = device.description.compute_queue.fam_idx.index != device.description.graphics_queue.fam_idx.index;
+        if(!dedicated_family)
+            INFORM("WARNING : no dedicated compute family, async compute will share the graphics family");
+    }
+
+    //records and submits compute work. Only blocks if all slots are still executing on the GPU.
+    //wait may be VK_NULL_HANDLE.
+    bool submit(record_fnc record, VkSemaphore wait = VK_NULL_HANDLE, VkPipelineStageFlags wait_stage = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+    const bool throws = true)
+    {
+        auto& slot = slots[next_slot];
+        const auto& cmd_buffer = command_buffers.handle[next_slot];
+
+        VkFence slot_fence = slot.f_finished;
+        vkWaitForFences(device, 1, &slot_fence, VK_TRUE, UINT64_MAX);
+        vkResetFences(device, 1, &slot_fence);
+
+        VkCommandBufferBeginInfo begin_info{};
+        begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+        EXIT_IF(vkBeginCommandBuffer(cmd_buffer, &begin_info), "FAILED TO BEGIN COMPUTE CMD BUFFER", DO_NOTHING);
+        record(cmd_buffer);
+        EXIT_IF(vkEndCommandBuffer(cmd_buffer), "FAILED TO END COMPUTE CMD BUFFER", DO_NOTHING);
+
+        std::vector<VkSemaphore> wait_semaphores;
+        std::vector<VkPipelineStageFlags> wait_stages;
+        if(wait != VK_NULL_HANDLE)
+            wait_semaphores.push_back(wait), wait_stages.push_back(wait_stage);
+        //nobody consumed the previous result, so we consume it here to keep the semaphore unsignalled
+        if(pending_slot.has_value())
+        {
+            wait_semaphores.push_back(slots[pending_slot.value()].s_finished);
+            wait_stages.push_back(VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+            pending_slot.reset();
+        }
+
+        VkSubmitInfo submit_info{};
+        submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        submit_info.commandBufferCount = 1, submit_info.pCommandBuffers = &cmd_buffer;
+        submit_info.waitSemaphoreCount = static_cast<uint32_t>(wait_semaphores.size());
+        submit_info.pWaitSemaphores    = wait_semaphores.data();
+        submit_info.pWaitDstStageMask  = wait_stages.data();
+        VkSemaphore signal = slot.s_finished;
+        submit_info.signalSemaphoreCount = 1, submit_info.pSignalSemaphores = &signal;
+
+        EXIT_IF(vkQueueSubmit(queue, 1, &submit_info, slot_fence), "FAILED TO SUBMIT COMPUTE CMD BUFFER", DO_NOTHING);
+
+        pending_slot = next_slot;
+        next_slot = (next_slot + 1) % slots.size();
+        return true;
+    }
+
+    //returns the semaphore signalled by the latest submission, or VK_NULL_HANDLE if there is nothing to wait on.
+    //the caller must wait on the returned semaphore in its next submit.
+    VkSemaphore take_wait_semaphore()
+    {
+        if(!pending_slot.has_value())
+            return VK_NULL_HANDLE;
+        VkSemaphore semaphore = slots[pending_slot.value()].s_finished;
+        pending_slot.reset();
+        return semaphore;
+    }
+    //stage of the graphics pipeline that consumes compute results
+    VkPipelineStageFlags get_consumer_stage() const {return consumer_stage;}
+    bool has_dedicated_family() const {return dedicated_family;}
+    uint32_t get_queue_family() const {return command_pool.description.queue_fam_index;}
+
+private:
+    struct slot_data
+    {
+        vk_handle::fence     f_finished;
+        vk_handle::semaphore s_finished;
+        slot_data(const vk_handle::device& device) :
+        f_finished(vk_handle::description::fence_desc{device, VK_FENCE_CREATE_SIGNALED_BIT}),
+        s_finished(vk_handle::description::semaphore_desc{device})
+        {
+        }
+    };
+    vk_handle::cmd_pool         command_pool;
+    vk_handle::cmd_buffers   command_buffers;
+    std::vector<slot_data>             slots;
+
+    VkPipelineStageFlags consumer_stage;
+    VkDevice                     device;
+    VkQueue                       queue;
+    bool               dedicated_family;
+
+    uint32_t                 next_slot = 0;
+    std::optional<uint32_t>  pending_slot;
+};
@@ -0,0 +1,282 @@
+#pragma once
+
+#include "vulkan_handle.h"
+#include "vulkan_data_getters.h"
+
+#include <algorithm>
+#include <array>
+
+/*
+    One global descriptor set holding every buffer, sampled image and sampler the engine knows about.
+    It is bound once per command buffer, and shaders index it with IDs handed to them through a push constant :
+
+        layout(set = 0, binding = 0) buffer       buffers_t {uint data[];} buffers[];
+        layout(set = 0, binding = 1) uniform texture2D textures[];
+        layout(set = 0, binding = 2) uniform sampler   samplers[];
+
+    Indices are stable for the lifetime of a resource. Released indices are only reused after frames_in_flight
+    calls to end_frame(), so a frame still executing on the GPU never sees its descriptor change underneath it.
+
+    Requires device.description.descriptor_indexing_features (core 1.2 or VK_EXT_descriptor_indexing).
+*/
+class bindless_heap_t
+{
+public:
+    enum binding_index : uint32_t
+    {
+        BUFFERS  = 0,
+        IMAGES   = 1,
+        SAMPLERS = 2,
+    };
+    struct capacity
+    {
+        uint32_t buffers  = 1 << 16;
+        uint32_t images   = 1 << 16;
+        uint32_t samplers = 1 << 10;
+    };
+
+    //a vk_handle wrapper that owns a slot in the heap for as long as it lives
+    template<typename wrapper_t> class resource
+    {
+    public:
+        wrapper_t   handle;
+        uint32_t     index;
+
+        operator uint32_t() const {return index;}
+
+        resource(wrapper_t&& handle, uint32_t index, binding_index binding, bindless_heap_t* heap) :
+        handle(std::move(handle)), index(index), binding(binding), heap(heap) {}
+        resource(resource&& other) : handle(std::move(other.handle)), index(other.index), binding(other.binding), heap(other.heap)
+        {
+            other.heap = nullptr;
+        }
+        resource& operator=(resource&& other)
+        {
+            release();
+            handle = std::move(other.handle), index = other.index, binding = other.binding, heap = other.heap;
+            other.heap = nullptr;
+            return *this;
+        }
+        resource(const resource&) = delete;
+        resource& operator=(const resource&) = delete;
+        ~resource(){release();}
+
+    private:
+        binding_index      binding;
+        bindless_heap_t*      heap;
+        void release()
+        {
+            if(heap != nullptr)
+                heap->release(binding, index);
+            heap = nullptr;
+        }
+    };
+    //a sampled image and the view the heap's slot points at
+    struct image_and_view
+    {
+        vk_handle::image      image;
+        vk_handle::image_view  view;
+    };
+    typedef resource<vk_handle::buffer>   buffer;
+    typedef resource<image_and_view>       image;
+    typedef resource<vk_handle::sampler> sampler;
+
+    //capacity's defaults aren't usable in a default argument of its enclosing class, hence the overload
+    bindless_heap_t(const vk_handle::device& device, uint32_t frames_in_flight) : bindless_heap_t(device, frames_in_flight, capacity{}) {}
+    bindless_heap_t(const vk_handle::device& device, uint32_t frames_in_flight, capacity requested) :
+    device(device), frames_in_flight(frames_in_flight),
+    caps(clamp_capacity(device, requested)),
+    set_layout(get_layout_desc(device, caps)),
+    pool(get_pool_desc(device, caps)),
+    set(vk_handle::description::descriptor_sets_desc{.parent = device, .pool = pool, .layouts = {set_layout}})
+    {
+        slots[BUFFERS].capacity  = caps.buffers;
+        slots[IMAGES].capacity   = caps.images;
+        slots[SAMPLERS].capacity = caps.samplers;
+    }
+
+    //creates the buffer through vk_handle and gives it a permanent slot.
+    //the buffer must have been created with VK_BUFFER_USAGE_STORAGE_BUFFER_BIT
+    buffer create_buffer(vk_handle::description::buffer_desc desc)
+    {
+        vk_handle::buffer handle(desc);
+        uint32_t index = add_buffer(handle, 0, VK_WHOLE_SIZE);
+        return buffer(std::move(handle), index, BUFFERS, this);
+    }
+    //creates the image and a view of it, view_desc.image is filled in. The image must have VK_IMAGE_USAGE_SAMPLED_BIT
+    //and be in layout whenever a shader reads it
+    image create_image(vk_handle::description::image_desc desc, vk_handle::description::image_view_desc view_desc,
+    VkImageLayout layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL)
+    {
+        vk_handle::image handle(desc);
+        view_desc.image = handle;
+        image_and_view owned{std::move(handle), vk_handle::image_view(view_desc)};
+        uint32_t index = add_image(owned.view, layout);
+        return image(std::move(owned), index, IMAGES, this);
+    }
+    sampler create_sampler(vk_handle::description::sampler_desc desc)
+    {
+        vk_handle::sampler handle(desc);
+        uint32_t index = add_sampler(handle);
+        return sampler(std::move(handle), index, SAMPLERS, this);
+    }
+
+    //for resources the heap doesn't own. Call release() when done.
+    uint32_t add_buffer(VkBuffer handle, VkDeviceSize offset, VkDeviceSize range)
+    {
+        uint32_t index = acquire(BUFFERS);
+        VkDescriptorBufferInfo info{handle, offset, range};
+        VkWriteDescriptorSet write = get_write(BUFFERS, index, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
+        write.pBufferInfo = &info;
+        vkUpdateDescriptorSets(device, 1, &write, 0, nullptr);
+        return index;
+    }
+    uint32_t add_image(VkImageView view, VkImageLayout layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL)
+    {
+        uint32_t index = acquire(IMAGES);
+        VkDescriptorImageInfo info{VK_NULL_HANDLE, view, layout};
+        VkWriteDescriptorSet write = get_write(IMAGES, index, VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE);
+        write.pImageInfo = &info;
+        vkUpdateDescriptorSets(device, 1, &write, 0, nullptr);
+        return index;
+    }
+    uint32_t add_sampler(VkSampler handle)
+    {
+        uint32_t index = acquire(SAMPLERS);
+        VkDescriptorImageInfo info{handle, VK_NULL_HANDLE, VK_IMAGE_LAYOUT_UNDEFINED};
+        VkWriteDescriptorSet write = get_write(SAMPLERS, index, VK_DESCRIPTOR_TYPE_SAMPLER);
+        write.pImageInfo = &info;
+        vkUpdateDescriptorSets(device, 1, &write, 0, nullptr);
+        return index;
+    }
+    void release(binding_index binding, uint32_t index)
+    {
+        slots[binding].retired.push_back({index, frame_counter});
+    }
+
+    //call once per frame. Indices retired frames_in_flight frames ago become reusable
+    void end_frame()
+    {
+        frame_counter++;
+        for(auto& s : slots)
+        {
+            auto itr = std::remove_if(s.retired.begin(), s.retired.end(), [&](const retired_index& r)
+            {
+                if(frame_counter - r.frame < frames_in_flight)
+                    return false;
+                s.free.push_back(r.index);
+                return true;
+            });
+            s.retired.erase(itr, s.retired.end());
+        }
+    }
+
+    void bind(VkCommandBuffer cmd, VkPipelineLayout layout, VkPipelineBindPoint bind_point = VK_PIPELINE_BIND_POINT_GRAPHICS) const
+    {
+        vkCmdBindDescriptorSets(cmd, bind_point, layout, 0, 1, &set.handle[0], 0, nullptr);
+    }
+    VkDescriptorSetLayout get_set_layout() const {return set_layout;}
+    capacity get_capacity() const {return caps;}
+
+private:
+    struct retired_index
+    {
+        uint32_t index;
+        uint64_t frame;
+    };
+    struct slot_list
+    {
+        uint32_t capacity  = 0;
+        uint32_t next      = 0;
+        std::vector<uint32_t> free;
+        std::vector<retired_index> retired;
+    };
+
+    uint32_t acquire(binding_index binding)
+    {
+        auto& s = slots[binding];
+        if(!s.free.empty())
+        {
+            uint32_t index = s.free.back();
+            s.free.pop_back();
+            return index;
+        }
+        if(s.next == s.capacity)
+            THROW("bindless heap is full");
+        return s.next++;
+    }
+    VkWriteDescriptorSet get_write(binding_index binding, uint32_t index, VkDescriptorType type) const
+    {
+        VkWriteDescriptorSet write{};
+        write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        write.dstSet          = set.handle[0];
+        write.dstBinding      = binding;
+        write.dstArrayElement = index;
+        write.descriptorCount = 1;
+        write.descriptorType  = type;
+        return write;
+    }
+
+    static capacity clamp_capacity(const vk_handle::device& device, capacity requested)
+    {
+        if(!device.description.descriptor_indexing_features.has_value())
+            THROW("bindless heap requires descriptor indexing");
+        auto props = vk_handle::data_getters::physical_device::get_descriptor_indexing_properties(device.description.phys_device);
+        capacity caps{};
+        caps.buffers  = std::min({requested.buffers, props.maxDescriptorSetUpdateAfterBindStorageBuffers,
+        props.maxPerStageDescriptorUpdateAfterBindStorageBuffers});
+        caps.images   = std::min({requested.images, props.maxDescriptorSetUpdateAfterBindSampledImages,
+        props.maxPerStageDescriptorUpdateAfterBindSampledImages});
+        caps.samplers = std::min({requested.samplers, props.maxDescriptorSetUpdateAfterBindSamplers,
+        props.maxPerStageDescriptorUpdateAfterBindSamplers});
+        //every binding is visible to every stage, so together they count against the per stage resource limit too
+        uint64_t total = uint64_t(caps.buffers) + caps.images + caps.samplers;
+        if(total > props.maxPerStageUpdateAfterBindResources)
+        {
+            double scale = double(props.maxPerStageUpdateAfterBindResources) / double(total);
+            caps.buffers  = static_cast<uint32_t>(caps.buffers * scale);
+            caps.images   = static_cast<uint32_t>(caps.images * scale);
+            caps.samplers = static_cast<uint32_t>(caps.samplers * scale);
+        }
+        return caps;
+    }
+    static vk_handle::description::descriptor_set_layout_desc get_layout_desc(VkDevice device, capacity caps)
+    {
+        vk_handle::description::descriptor_set_layout_desc desc{};
+        desc.parent = device;
+        desc.flags  = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT;
+        desc.bindings = {
+            {BUFFERS , VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, caps.buffers , VK_SHADER_STAGE_ALL, nullptr},
+            {IMAGES  , VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE , caps.images  , VK_SHADER_STAGE_ALL, nullptr},
+            {SAMPLERS, VK_DESCRIPTOR_TYPE_SAMPLER       , caps.samplers, VK_SHADER_STAGE_ALL, nullptr}
+        };
+        //slots are filled lazily and written while the set is bound
+        VkDescriptorBindingFlags flags = VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT | VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT;
+        desc.binding_flags = {flags, flags, flags};
+        return desc;
+    }
+    static vk_handle::description::descriptor_pool_desc get_pool_desc(VkDevice device, capacity caps)
+    {
+        vk_handle::description::descriptor_pool_desc desc{};
+        desc.parent   = device;
+        desc.max_sets = 1;
+        desc.flags    = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT;
+        desc.pool_sizes = {
+            {VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, caps.buffers},
+            {VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE , caps.images},
+            {VK_DESCRIPTOR_TYPE_SAMPLER       , caps.samplers}
+        };
+        return desc;
+    }
+
+    VkDevice           device;
+    uint32_t frames_in_flight;
+    uint64_t frame_counter = 0;
+    capacity             caps;
+
+    vk_handle::descriptor_set_layout set_layout;
+    vk_handle::descriptor_pool             pool;
+    vk_handle::descriptor_sets              set;
+
+    std::array<slot_list, 3> slots;
+};
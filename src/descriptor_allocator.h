@@ -0,0 +1,186 @@
+#pragma once
+
+#include "vulkan_handle.h"
+#include "hash.h"
+
+#include <unordered_map>
+#include <algorithm>
+#include <optional>
+
+/*
+    Hands out one VkDescriptorSetLayout per distinct set of bindings.
+    Layouts live as long as the cache, so the returned handles must not be destroyed by the caller.
+*/
+class descriptor_layout_cache_t
+{
+public:
+    descriptor_layout_cache_t(VkDevice device) : device(device) {}
+
+    VkDescriptorSetLayout get(std::vector<VkDescriptorSetLayoutBinding> bindings, VkDescriptorSetLayoutCreateFlags flags = 0)
+    {
+        //binding order doesn't matter to vulkan, so it shouldn't matter to the key either
+        std::sort(bindings.begin(), bindings.end(), [](const VkDescriptorSetLayoutBinding& a, const VkDescriptorSetLayoutBinding& b)
+        {return a.binding < b.binding;});
+        layout_key key{bindings, flags};
+
+        auto itr = layouts.find(key);
+        if(itr != layouts.end())
+            return itr->second;
+
+        vk_handle::description::descriptor_set_layout_desc desc{};
+        desc.parent   = device;
+        desc.bindings = bindings;
+        desc.flags    = flags;
+        auto result = layouts.emplace(std::move(key), vk_handle::descriptor_set_layout(desc));
+        layout_flags.emplace(result.first->second, flags);
+        return result.first->second;
+    }
+    //the flags a layout handed out by this cache was created with, nothing for layouts from elsewhere
+    std::optional<VkDescriptorSetLayoutCreateFlags> flags(VkDescriptorSetLayout layout) const
+    {
+        auto itr = layout_flags.find(layout);
+        if(itr == layout_flags.end())
+            return std::nullopt;
+        return itr->second;
+    }
+    size_t size() const {return layouts.size();}
+
+private:
+    struct layout_key
+    {
+        std::vector<VkDescriptorSetLayoutBinding> bindings;
+        VkDescriptorSetLayoutCreateFlags flags;
+        bool operator ==(const layout_key& rhs) const
+        {
+            if(flags != rhs.flags || bindings.size() != rhs.bindings.size())
+                return false;
+            for(size_t i = 0; i < bindings.size(); ++i)
+            {
+                const auto& a = bindings[i];
+                const auto& b = rhs.bindings[i];
+                if(a.binding != b.binding || a.descriptorType != b.descriptorType || a.descriptorCount != b.descriptorCount
+                || a.stageFlags != b.stageFlags || a.pImmutableSamplers != b.pImmutableSamplers)
+                    return false;
+            }
+            return true;
+        }
+    };
+    struct layout_key_hash
+    {
+        size_t operator()(const layout_key& key) const
+        {
+            uint64_t hash = hash_value(key.flags);
+            for(const auto& binding : key.bindings)
+            {
+                hash = hash_value(binding.binding, hash);
+                hash = hash_value(binding.descriptorType, hash);
+                hash = hash_value(binding.descriptorCount, hash);
+                hash = hash_value(binding.stageFlags, hash);
+                hash = hash_value(binding.pImmutableSamplers, hash);
+            }
+            return static_cast<size_t>(hash);
+        }
+    };
+
+    VkDevice device;
+    std::unordered_map<layout_key, vk_handle::descriptor_set_layout, layout_key_hash> layouts;
+    //flags() looks layouts up by handle, so keep a handle keyed map instead of scanning the keys
+    std::unordered_map<VkDescriptorSetLayout, VkDescriptorSetLayoutCreateFlags> layout_flags;
+};
+
+/*
+    Per frame-in-flight descriptor set allocator.
+    Sets are never freed one by one. Instead, once a frame's fence has signalled, reset() hands every pool
+    of that frame back with a single vkResetDescriptorPool each. When a pool runs dry, the next one in the
+    chain is used, and a new pool is created if there is none.
+*/
+class descriptor_allocator_t
+{
+public:
+    //how many descriptors of a type to reserve per set in a pool
+    struct pool_ratio
+    {
+        VkDescriptorType type;
+        float           ratio;
+    };
+
+    descriptor_allocator_t(VkDevice device, uint32_t frames_in_flight, std::vector<pool_ratio> ratios, uint32_t sets_per_pool = 256) :
+    device(device), ratios(ratios), sets_per_pool(sets_per_pool), frames(frames_in_flight)
+    {
+    }
+
+    //returns VK_NULL_HANDLE on failure, or throws if throws is set
+    VkDescriptorSet allocate(uint32_t frame_index, VkDescriptorSetLayout layout, const bool throws = true)
+    {
+        auto& frame = frames[frame_index];
+        while(true)
+        {
+            if(frame.current == frame.pools.size())
+            {
+                frame.pools.emplace_back(get_pool_desc(), throws);
+                if(frame.pools.back().handle == VK_NULL_HANDLE)
+                {
+                    frame.pools.pop_back();
+                    return VK_NULL_HANDLE;
+                }
+            }
+
+            VkDescriptorSetAllocateInfo info{};
+            info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+            info.descriptorPool     = frame.pools[frame.current];
+            info.descriptorSetCount = 1;
+            info.pSetLayouts        = &layout;
+
+            VkDescriptorSet set = VK_NULL_HANDLE;
+            auto result = vkAllocateDescriptorSets(device, &info, &set);
+            if(result == VK_SUCCESS)
+            {
+                frame.sets_in_current++;
+                return set;
+            }
+            //this pool is exhausted, move on to the next in the chain.
+            //an empty pool that can't hold the set never will, neither will the ones after it
+            bool exhausted = result == VK_ERROR_OUT_OF_POOL_MEMORY || result == VK_ERROR_FRAGMENTED_POOL;
+            if(exhausted && frame.sets_in_current > 0)
+            {
+                frame.current++, frame.sets_in_current = 0;
+                continue;
+            }
+            if(throws)
+                THROW("Failed to allocate descriptor set");
+            return VK_NULL_HANDLE;
+        }
+    }
+    //all sets allocated for frame_index become invalid. Only call this once the GPU is done with that frame!
+    void reset(uint32_t frame_index)
+    {
+        auto& frame = frames[frame_index];
+        for(size_t i = 0; i < frame.pools.size() && i <= frame.current; ++i)
+            vkResetDescriptorPool(device, frame.pools[i], 0);
+        frame.current = 0, frame.sets_in_current = 0;
+    }
+
+private:
+    struct frame_pools
+    {
+        std::vector<vk_handle::descriptor_pool> pools;
+        size_t current = 0;
+        size_t sets_in_current = 0;
+    };
+
+    vk_handle::description::descriptor_pool_desc get_pool_desc() const
+    {
+        vk_handle::description::descriptor_pool_desc desc{};
+        desc.parent   = device;
+        desc.max_sets = sets_per_pool;
+        desc.pool_sizes.reserve(ratios.size());
+        for(const auto& r : ratios)
+            desc.pool_sizes.push_back(VkDescriptorPoolSize{r.type, std::max(1u, static_cast<uint32_t>(r.ratio * sets_per_pool))});
+        return desc;
+    }
+
+    VkDevice                          device;
+    std::vector<pool_ratio>           ratios;
+    uint32_t                   sets_per_pool;
+    std::vector<frame_pools>          frames;
+};
@@ -0,0 +1,233 @@
+#pragma once
+
+#include "vulkan_handle.h"
+
+#include <atomic>
+#include <optional>
+#include <unordered_map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/*
+    Everything the engine asks a physical device about, queried once per device :
+
+        const auto& caps = device_capabilities_t::get(phys_device);
+        caps.properties.limits.maxPushConstantsSize;
+        caps.vulkan12_features.timelineSemaphore;
+        caps.extensions.contains(VK_KHR_SWAPCHAIN_EXTENSION_NAME);
+
+    Extension names are interned into small ids, so a support check is a hash lookup and a bit test instead of a
+    string compare against every extension the driver lists. The 1.1, 1.2 and 1.3 structs stay zeroed on devices
+    that can't report them (each needs a device of at least 1.2, 1.2 and 1.3 respectively), and all the extension
+    structs come back from the same single Properties2/Features2 pair.
+
+    Snapshots live until clear(), which the context calls when it destroys the instance they came from.
+*/
+namespace vk_handle
+{
+    //hands out one id per distinct extension name, for the lifetime of the program
+    class extension_names_t
+    {
+    public:
+        static uint32_t intern(const char* name)
+        {
+            auto& table = get_table();
+            std::lock_guard<std::mutex> guard(table.lock);
+            auto result = table.ids.try_emplace(name, static_cast<uint32_t>(table.ids.size()));
+            return result.first->second;
+        }
+    private:
+        struct table_t
+        {
+            std::mutex                                   lock;
+            std::unordered_map<std::string, uint32_t>     ids;
+        };
+        static table_t& get_table()
+        {
+            static table_t table;
+            return table;
+        }
+    };
+
+    class extension_set_t
+    {
+    public:
+        void insert(uint32_t id)
+        {
+            if(id / 64 >= bits.size())
+                bits.resize(id / 64 + 1, 0);
+            bits[id / 64] |= uint64_t(1) << (id % 64);
+        }
+        bool contains(uint32_t id) const
+        {
+            return id / 64 < bits.size() && (bits[id / 64] & (uint64_t(1) << (id % 64)));
+        }
+        bool contains(const char* name) const {return contains(extension_names_t::intern(name));}
+        bool contains(const std::vector<std::string>& names) const
+        {
+            for(const auto& name : names)
+                if(!contains(name.c_str()))
+                    return false;
+            return true;
+        }
+    private:
+        std::vector<uint64_t> bits;
+    };
+
+    struct device_capabilities_t
+    {
+        VkPhysicalDeviceProperties                   properties{};
+        VkPhysicalDeviceVulkan11Properties   vulkan11_properties{};
+        VkPhysicalDeviceVulkan12Properties   vulkan12_properties{};
+        VkPhysicalDeviceVulkan13Properties   vulkan13_properties{};
+        VkPhysicalDeviceFeatures                       features{};
+        VkPhysicalDeviceVulkan11Features       vulkan11_features{};
+        VkPhysicalDeviceVulkan12Features       vulkan12_features{};
+        VkPhysicalDeviceVulkan13Features       vulkan13_features{};
+        VkPhysicalDeviceMemoryProperties      memory_properties{};
+        //the extension structs below are nothing (or zeroed) below 1.1 or when the device doesn't list the extension,
+        //dynamic rendering also needs 1.2
+        std::optional<VkPhysicalDeviceDescriptorIndexingFeatures>                descriptor_indexing_features;
+        std::optional<VkPhysicalDeviceGraphicsPipelineLibraryFeaturesEXT> graphics_pipeline_library_features;
+        std::optional<VkPhysicalDeviceDynamicRenderingFeaturesKHR>                dynamic_rendering_features;
+        std::optional<VkPhysicalDeviceShaderObjectFeaturesEXT>                        shader_object_features;
+        std::optional<VkPhysicalDeviceExtendedDynamicStateFeaturesEXT>       extended_dynamic_state_features;
+        std::optional<VkPhysicalDeviceExtendedDynamicState2FeaturesEXT>    extended_dynamic_state_2_features;
+        std::optional<VkPhysicalDeviceExtendedDynamicState3FeaturesEXT>    extended_dynamic_state_3_features;
+        VkPhysicalDeviceDescriptorIndexingProperties                    descriptor_indexing_properties{};
+        VkPhysicalDeviceGraphicsPipelineLibraryPropertiesEXT      graphics_pipeline_library_properties{};
+        VkPhysicalDevicePushDescriptorPropertiesKHR                         push_descriptor_properties{};
+        std::vector<VkQueueFamilyProperties>     queue_families;
+        std::vector<std::string>            extension_names;   //as the driver listed them
+        extension_set_t                          extensions;
+
+        //queries the device on the first call, thread safe
+        static const device_capabilities_t& get(VkPhysicalDevice handle)
+        {
+            auto& cache = get_cache();
+            cache.lookups.fetch_add(1, std::memory_order_relaxed);
+            std::lock_guard<std::mutex> guard(cache.lock);
+            auto& entry = cache.snapshots[handle];
+            if(entry == nullptr)
+                entry = std::make_unique<device_capabilities_t>(query(handle));
+            return *entry;
+        }
+        //the handles are only valid as long as their instance
+        static void clear()
+        {
+            auto& cache = get_cache();
+            std::lock_guard<std::mutex> guard(cache.lock);
+            cache.snapshots.clear();
+        }
+        //how many times get() was asked, each one went to the driver before there were snapshots
+        static uint64_t lookups()
+        {
+            return get_cache().lookups.load(std::memory_order_relaxed);
+        }
+        //asks the driver every time, get() is what callers want
+        static device_capabilities_t query(VkPhysicalDevice handle)
+        {
+            device_capabilities_t caps{};
+            vkGetPhysicalDeviceProperties(handle, &caps.properties);
+            vkGetPhysicalDeviceFeatures(handle, &caps.features);
+            vkGetPhysicalDeviceMemoryProperties(handle, &caps.memory_properties);
+
+            uint32_t count = 0;
+            vkGetPhysicalDeviceQueueFamilyProperties(handle, &count, nullptr);
+            caps.queue_families.resize(count);
+            vkGetPhysicalDeviceQueueFamilyProperties(handle, &count, caps.queue_families.data());
+
+            vkEnumerateDeviceExtensionProperties(handle, nullptr, &count, nullptr);
+            std::vector<VkExtensionProperties> extensions(count);
+            vkEnumerateDeviceExtensionProperties(handle, nullptr, &count, extensions.data());
+            caps.extension_names.reserve(count);
+            for(const auto& extension : extensions)
+            {
+                caps.extension_names.push_back(extension.extensionName);
+                caps.extensions.insert(extension_names_t::intern(extension.extensionName));
+            }
+
+            //every struct below rides on one Properties2 and one Features2 call
+            uint32_t version = caps.properties.apiVersion;
+            if(version < VK_API_VERSION_1_1)
+                return caps;
+            std::vector<void**> linked;
+            VkPhysicalDeviceProperties2 p{};
+            p.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+            VkPhysicalDeviceFeatures2 f{};
+            f.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+            auto link = [&linked](auto& s, VkStructureType type, void*& chain)
+            {
+                s.sType = type;
+                s.pNext = chain;
+                chain   = &s;
+                linked.push_back(&s.pNext);
+            };
+            auto link_optional = [&link](auto& s, VkStructureType type, void*& chain)
+            {
+                s.emplace();
+                link(s.value(), type, chain);
+            };
+
+            link(caps.descriptor_indexing_properties, VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_PROPERTIES, p.pNext);
+            link_optional(caps.descriptor_indexing_features, VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES, f.pNext);
+            if(caps.extensions.contains(VK_KHR_PUSH_DESCRIPTOR_EXTENSION_NAME))
+                link(caps.push_descriptor_properties, VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PUSH_DESCRIPTOR_PROPERTIES_KHR, p.pNext);
+            if(caps.extensions.contains(VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME))
+            {
+                link(caps.graphics_pipeline_library_properties,
+                VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GRAPHICS_PIPELINE_LIBRARY_PROPERTIES_EXT, p.pNext);
+                link_optional(caps.graphics_pipeline_library_features,
+                VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GRAPHICS_PIPELINE_LIBRARY_FEATURES_EXT, f.pNext);
+            }
+            if(version >= VK_API_VERSION_1_2 && caps.extensions.contains(VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME))
+                link_optional(caps.dynamic_rendering_features, VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DYNAMIC_RENDERING_FEATURES_KHR, f.pNext);
+            if(caps.extensions.contains(VK_EXT_SHADER_OBJECT_EXTENSION_NAME))
+                link_optional(caps.shader_object_features, VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SHADER_OBJECT_FEATURES_EXT, f.pNext);
+            if(caps.extensions.contains(VK_EXT_EXTENDED_DYNAMIC_STATE_EXTENSION_NAME))
+                link_optional(caps.extended_dynamic_state_features,
+                VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTENDED_DYNAMIC_STATE_FEATURES_EXT, f.pNext);
+            if(caps.extensions.contains(VK_EXT_EXTENDED_DYNAMIC_STATE_2_EXTENSION_NAME))
+                link_optional(caps.extended_dynamic_state_2_features,
+                VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTENDED_DYNAMIC_STATE_2_FEATURES_EXT, f.pNext);
+            if(caps.extensions.contains(VK_EXT_EXTENDED_DYNAMIC_STATE_3_EXTENSION_NAME))
+                link_optional(caps.extended_dynamic_state_3_features,
+                VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTENDED_DYNAMIC_STATE_3_FEATURES_EXT, f.pNext);
+
+            //the per version structs came with 1.2, and 1.3 only exists on 1.3 devices
+            if(version >= VK_API_VERSION_1_2)
+            {
+                link(caps.vulkan11_properties, VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_1_PROPERTIES, p.pNext);
+                link(caps.vulkan12_properties, VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_PROPERTIES, p.pNext);
+                link(caps.vulkan11_features,   VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_1_FEATURES,   f.pNext);
+                link(caps.vulkan12_features,   VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES,   f.pNext);
+            }
+            if(version >= VK_API_VERSION_1_3)
+            {
+                link(caps.vulkan13_properties, VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_PROPERTIES, p.pNext);
+                link(caps.vulkan13_features,   VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES,   f.pNext);
+            }
+
+            vkGetPhysicalDeviceProperties2(handle, &p);
+            vkGetPhysicalDeviceFeatures2(handle, &f);
+            //the snapshot is copied around, nothing in it may point into it
+            for(auto next : linked)
+                *next = nullptr;
+            return caps;
+        }
+
+        struct cache_t
+        {
+            std::mutex                                                                    lock;
+            std::atomic<uint64_t>                                                      lookups{0};
+            std::unordered_map<VkPhysicalDevice, std::unique_ptr<device_capabilities_t>> snapshots;
+        };
+        static cache_t& get_cache()
+        {
+            static cache_t cache;
+            return cache;
+        }
+    };
+}
@@ -0,0 +1,261 @@
+#pragma once
+
+#include "vulkan_handle.h"
+#include "vulkan_data_getters.h"
+#include "descriptor_allocator.h"
+#include "push_constants.h"
+#include "spirv_reflect.h"
+#include "embedded_shaders.h"
+
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <map>
+#include <array>
+#include <cmath>
+#include <string>
+
+/*
+    Measures how fast a physical device moves memory, for telling apart devices that look alike on paper :
+
+        device_probe_t probe("device_probe.cache");
+        auto picked = get::physical_device::pick_best_physical_device(devices,
+        [&](VkPhysicalDevice device){return probe.score(instance, device);});
+        probe.save();
+
+    A probe creates a throwaway device and times a few 64MiB buffer copies and compute dispatches (probe.comp, which
+    reads and writes every byte like the copy does) on the host, a few tens of milliseconds per device. Results are
+    kept per device UUID and driver version in a small text file, so only new devices and driver updates are probed
+    again. A device that can't be probed (out of memory, device creation failed) measures zero for this run only, it
+    is probed again next time.
+
+    Probing uses whatever device functions volk has loaded, it has to run before volkLoadDevice.
+*/
+class device_probe_t
+{
+public:
+    struct result_t
+    {
+        double     copy_gbps = 0.0;
+        double dispatch_gbps = 0.0;
+    };
+
+    device_probe_t(const char* cache_path) : cache_path(cache_path)
+    {
+        //a missing, garbled or older file just means probing again
+        std::ifstream file(cache_path);
+        std::string format, key;
+        result_t result;
+        if(!(file >> format) || format != FILE_FORMAT)
+            return;
+        while(file >> key >> result.copy_gbps >> result.dispatch_gbps)
+            results[key] = result;
+    }
+
+    //zero if the device can't be probed, which isn't remembered
+    result_t measure(VkInstance instance, VkPhysicalDevice phys_device)
+    {
+        auto key = get_key(phys_device);
+        auto itr = results.find(key);
+        if(itr != results.end())
+            return itr->second;
+
+        const char* name = vk_handle::data_getters::physical_device::get_properties(phys_device).deviceName;
+        result_t result{};
+        try
+        {
+            result = run(instance, phys_device);
+        }
+        catch(const std::exception& e)
+        {
+            INFORM_ERR("WARNING : probing " << name << " failed : " << e.what());
+            return result_t{};
+        }
+        if(!(result.copy_gbps > 0.0 && result.dispatch_gbps > 0.0 && std::isfinite(result.copy_gbps) && std::isfinite(result.dispatch_gbps)))
+        {
+            INFORM_ERR("WARNING : probing " << name << " measured nothing");
+            return result_t{};
+        }
+        INFORM(name << " : copies at " << result.copy_gbps << "GB/s, dispatches at " << result.dispatch_gbps << "GB/s");
+        dirty = true;
+        return results[key] = result;
+    }
+    //bonus points for pick_best_physical_device, a few GB/s are worth more than anything the device reports about itself
+    double score(VkInstance instance, VkPhysicalDevice phys_device)
+    {
+        auto result = measure(instance, phys_device);
+        return 100.0 * (result.copy_gbps + result.dispatch_gbps) / 2.0;
+    }
+
+    bool save() const
+    {
+        if(!dirty)
+            return true;
+        std::ofstream file(cache_path, std::ios::trunc);
+        if(!file.is_open())
+            return false;
+        file << FILE_FORMAT << '\n';
+        for(const auto& [key, result] : results)
+            file << key << ' ' << result.copy_gbps << ' ' << result.dispatch_gbps << '\n';
+        return file.good();
+    }
+
+    //one uncached probe on a device created with profile, throws if it can't be done
+    static result_t run(VkInstance instance, VkPhysicalDevice phys_device,
+    vk_handle::data_getters::device::feature_profile profile = vk_handle::data_getters::device::MINIMAL)
+    {
+        namespace get  = vk_handle::data_getters;
+        namespace data = vk_handle::description;
+
+        vk_handle::device device(get::device::description(instance, phys_device, true, profile));
+        auto funcs = get::vma_functions();
+        vk_handle::allocator allocator(VmaAllocatorCreateInfo{
+            .physicalDevice   = phys_device,
+            .device           = device,
+            .pVulkanFunctions = &funcs,
+            .instance         = instance
+        });
+        auto buffer_desc = [&]()
+        {
+            return data::buffer_desc
+            {
+                .parent    = device,
+                .allocator = allocator,
+                .alloc_info = VmaAllocationCreateInfo
+                {
+                    .usage = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE,
+                    .pool = VK_NULL_HANDLE
+                },
+                .size  = PROBE_SIZE,
+                .usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                .queue_fam_indices = {device.description.graphics_queue.fam_idx}
+            };
+        };
+        vk_handle::buffer source(buffer_desc()), destination(buffer_desc());
+
+        //probe.comp copies source into destination, one uvec4 per invocation
+        constexpr const auto& code = embedded_shaders::get("probe_comp.spv");
+        data::shader_module_desc shader_desc{};
+        shader_desc.parent = device;
+        shader_desc.stage  = VK_SHADER_STAGE_COMPUTE_BIT;
+        shader_desc.entry_point_name = "main";
+        shader_desc.byte_code.assign(reinterpret_cast<const char*>(code.code), reinterpret_cast<const char*>(code.code) + code.size);
+        vk_handle::shader_module shader(shader_desc);
+        descriptor_layout_cache_t layout_cache(device);
+        vk_handle::pipeline_layout layout(spirv::pipeline_layout(device, {&spirv::reflect_cached(shader_desc.byte_code)}, layout_cache));
+        data::compute_pipeline_desc pipeline_desc{};
+        pipeline_desc.parent = device;
+        pipeline_desc.pipeline_layout = layout;
+        pipeline_desc.shader_stage_info.module      = shader;
+        pipeline_desc.shader_stage_info.entry_point = shader_desc.entry_point_name;
+        pipeline_desc.shader_stage_info.stage       = VK_SHADER_STAGE_COMPUTE_BIT;
+        vk_handle::compute_pipeline pipeline({pipeline_desc});
+        probe_push push(layout, phys_device);
+
+        descriptor_allocator_t sets(device, 1, {{VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 2.0f}}, 1);
+        VkDescriptorSet set = sets.allocate(0, layout.description.set_layouts[0]);
+        std::array<VkDescriptorBufferInfo, 2> buffers{VkDescriptorBufferInfo{source, 0, VK_WHOLE_SIZE},
+        VkDescriptorBufferInfo{destination, 0, VK_WHOLE_SIZE}};
+        std::array<VkWriteDescriptorSet, 2> writes{};
+        for(uint32_t i = 0; i < writes.size(); ++i)
+        {
+            writes[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            writes[i].dstSet = set, writes[i].dstBinding = i;
+            writes[i].descriptorCount = 1, writes[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            writes[i].pBufferInfo = &buffers[i];
+        }
+        vkUpdateDescriptorSets(device, static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
+
+        vk_handle::cmd_pool pool(data::cmd_pool_desc{.parent = device, .queue_fam_index = device.description.graphics_queue.fam_idx,
+        .flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT});
+        vk_handle::cmd_buffers cmd_buffers(data::cmd_buffers_desc{device, pool, 1, VK_COMMAND_BUFFER_LEVEL_PRIMARY});
+        vk_handle::fence f_done(data::fence_desc{device, VkFenceCreateFlags(0)});
+        VkQueue queue = get::device::queue_handle(device, device.description.graphics_queue);
+        VkCommandBuffer cmd = cmd_buffers.handle[0];
+        VkFence fence = f_done;
+
+        //seconds between submitting and the fence signaling
+        auto timed = [&](auto record) -> double
+        {
+            VkCommandBufferBeginInfo begin_info{};
+            begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+            begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+            vkBeginCommandBuffer(cmd, &begin_info);
+            for(uint32_t i = 0; i < REPEATS; ++i)
+            {
+                //each pass waits for the last, the way real work would
+                VkMemoryBarrier barrier{};
+                barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+                barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+                barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+                VkPipelineStageFlags stages = VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+                vkCmdPipelineBarrier(cmd, stages, stages, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+                record(cmd, i);
+            }
+            if(vkEndCommandBuffer(cmd) != VK_SUCCESS)
+                THROW("FAILED TO RECORD PROBE");
+
+            VkSubmitInfo submit_info{};
+            submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+            submit_info.commandBufferCount = 1, submit_info.pCommandBuffers = &cmd;
+            vkResetFences(device, 1, &fence);
+            auto start = std::chrono::steady_clock::now();
+            if(vkQueueSubmit(queue, 1, &submit_info, fence) != VK_SUCCESS || vkWaitForFences(device, 1, &fence, VK_TRUE, UINT64_MAX) != VK_SUCCESS)
+                THROW("FAILED TO RUN PROBE");
+            std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+            return elapsed.count();
+        };
+        VkBufferCopy region{0, 0, PROBE_SIZE};
+        auto copy = [&](VkCommandBuffer c, uint32_t){vkCmdCopyBuffer(c, source, destination, 1, &region);};
+        constexpr uint32_t COUNT = static_cast<uint32_t>(PROBE_SIZE / 16);
+        auto dispatch = [&](VkCommandBuffer c, uint32_t i)
+        {
+            vkCmdBindPipeline(c, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline.handle[0]);
+            vkCmdBindDescriptorSets(c, VK_PIPELINE_BIND_POINT_COMPUTE, layout, 0, 1, &set, 0, nullptr);
+            push.push(c, probe_data{COUNT, i});
+            vkCmdDispatch(c, (COUNT + LOCAL_SIZE - 1) / LOCAL_SIZE, 1, 1);
+        };
+
+        //the first submission pays for page faults, clocks ramping up and the pipeline's first use
+        timed(dispatch);
+        result_t result;
+        //both read and write every byte
+        result.copy_gbps     = 2.0 * REPEATS * PROBE_SIZE / timed(copy) / 1e9;
+        result.dispatch_gbps = 2.0 * REPEATS * PROBE_SIZE / timed(dispatch) / 1e9;
+        return result;
+    }
+
+private:
+    static constexpr VkDeviceSize PROBE_SIZE = VkDeviceSize(64) << 20;
+    static constexpr uint32_t        REPEATS = 8;
+    static constexpr uint32_t     LOCAL_SIZE = 256;  //local_size_x in probe.comp
+    //first token of the cache file, files from before probe.comp measured fills
+    static constexpr const char* FILE_FORMAT = "probe-v2";
+
+    //what probe.comp reads from its push constants
+    struct probe_data
+    {
+        uint32_t count;   //uvec4s to copy
+        uint32_t  pass;
+    };
+    typedef push_constant_t<probe_data, VK_SHADER_STAGE_COMPUTE_BIT> probe_push;
+
+    static std::string get_key(VkPhysicalDevice phys_device)
+    {
+        const auto& caps = vk_handle::device_capabilities_t::get(phys_device);
+        //the 1.1 properties are only queried on 1.2 devices, older ones go by their pipeline cache UUID
+        const uint8_t* uuid = caps.properties.apiVersion >= VK_API_VERSION_1_2 ? caps.vulkan11_properties.deviceUUID
+        : caps.properties.pipelineCacheUUID;
+        std::ostringstream key;
+        key << std::hex << std::setfill('0');
+        for(uint32_t i = 0; i < VK_UUID_SIZE; ++i)
+            key << std::setw(2) << uint32_t(uuid[i]);
+        key << '-' << caps.properties.driverVersion;
+        return key.str();
+    }
+
+    std::string                  cache_path;
+    std::map<std::string, result_t> results;
+    bool                          dirty = false;
+};
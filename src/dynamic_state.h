@@ -0,0 +1,175 @@
+#pragma once
+
+#include "vulkan_handle_description.h"
+
+#include <vector>
+#include <span>
+
+/*
+    Extended dynamic state (VK_EXT_extended_dynamic_state 1, 2 and 3) moves fixed function state out of the pipeline
+    and into the command buffer, so pipelines that only differed in it become one :
+
+        auto draw_state = draw_state_t::from(desc);          //the values the description would have baked
+        make_dynamic(desc, extended_dynamic_states(device.description));
+        ...
+        vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+        draw_state.cull_mode = VK_CULL_MODE_BACK_BIT;        //no new pipeline for this
+        draw_state.record(cmd, desc.dynamic_state_info.dynamic_state_list);
+
+    make_dynamic() resets the fields it makes dynamic to fixed values, so every key built from the description
+    (pipeline_permutations_t, pipeline_library_cache_t, pipeline_manifest_t) stops depending on them.
+*/
+
+//every state the device can set dynamically, of those draw_state_t knows about
+inline std::vector<VkDynamicState> extended_dynamic_states(const vk_handle::description::device_desc& device)
+{
+    std::vector<VkDynamicState> states;
+    if(device.extended_dynamic_state_features.has_value())
+        states.insert(states.end(), {VK_DYNAMIC_STATE_CULL_MODE_EXT, VK_DYNAMIC_STATE_FRONT_FACE_EXT,
+        VK_DYNAMIC_STATE_PRIMITIVE_TOPOLOGY_EXT, VK_DYNAMIC_STATE_DEPTH_TEST_ENABLE_EXT, VK_DYNAMIC_STATE_DEPTH_WRITE_ENABLE_EXT,
+        VK_DYNAMIC_STATE_DEPTH_COMPARE_OP_EXT});
+    if(device.extended_dynamic_state_2_features.has_value())
+        states.insert(states.end(), {VK_DYNAMIC_STATE_PRIMITIVE_RESTART_ENABLE_EXT, VK_DYNAMIC_STATE_DEPTH_BIAS_ENABLE_EXT,
+        VK_DYNAMIC_STATE_RASTERIZER_DISCARD_ENABLE_EXT});
+    if(device.extended_dynamic_state_3_features.has_value())
+    {
+        const auto& eds3 = device.extended_dynamic_state_3_features.value();
+        if(eds3.extendedDynamicState3PolygonMode)
+            states.push_back(VK_DYNAMIC_STATE_POLYGON_MODE_EXT);
+        if(eds3.extendedDynamicState3DepthClampEnable)
+            states.push_back(VK_DYNAMIC_STATE_DEPTH_CLAMP_ENABLE_EXT);
+    }
+    return states;
+}
+
+//a dynamic topology has to stay in the class of the baked one, so that is all that's kept
+inline VkPrimitiveTopology topology_class(VkPrimitiveTopology topology)
+{
+    switch(topology)
+    {
+        case VK_PRIMITIVE_TOPOLOGY_POINT_LIST :
+            return VK_PRIMITIVE_TOPOLOGY_POINT_LIST;
+        case VK_PRIMITIVE_TOPOLOGY_LINE_LIST :
+        case VK_PRIMITIVE_TOPOLOGY_LINE_STRIP :
+        case VK_PRIMITIVE_TOPOLOGY_LINE_LIST_WITH_ADJACENCY :
+        case VK_PRIMITIVE_TOPOLOGY_LINE_STRIP_WITH_ADJACENCY :
+            return VK_PRIMITIVE_TOPOLOGY_LINE_LIST;
+        case VK_PRIMITIVE_TOPOLOGY_PATCH_LIST :
+            return VK_PRIMITIVE_TOPOLOGY_PATCH_LIST;
+        default :
+            return VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+    }
+}
+
+//adds the states to the description's dynamic state and resets the fields they replace
+inline void make_dynamic(vk_handle::description::graphics_pipeline_desc& desc, std::span<const VkDynamicState> states)
+{
+    auto& list = desc.dynamic_state_info;
+    for(auto state : states)
+    {
+        if(list.is_dynamic(state))
+            continue;
+        list.dynamic_state_list.push_back(state);
+
+        auto& r = desc.rasterization_info;
+        switch(state)
+        {
+            case VK_DYNAMIC_STATE_CULL_MODE_EXT :
+                r.cull_mode = VK_CULL_MODE_NONE; break;
+            case VK_DYNAMIC_STATE_FRONT_FACE_EXT :
+                r.front_face = VK_FRONT_FACE_COUNTER_CLOCKWISE; break;
+            case VK_DYNAMIC_STATE_PRIMITIVE_TOPOLOGY_EXT :
+                desc.input_assembly_info.topology = topology_class(desc.input_assembly_info.topology); break;
+            case VK_DYNAMIC_STATE_PRIMITIVE_RESTART_ENABLE_EXT :
+                desc.input_assembly_info.primitive_restart_enabled = VK_FALSE; break;
+            case VK_DYNAMIC_STATE_DEPTH_BIAS_ENABLE_EXT :
+                r.depth_bias_enable = VK_FALSE; break;
+            case VK_DYNAMIC_STATE_RASTERIZER_DISCARD_ENABLE_EXT :
+                r.rasterization_discard = VK_FALSE; break;
+            case VK_DYNAMIC_STATE_POLYGON_MODE_EXT :
+                r.polygon_mode = VK_POLYGON_MODE_FILL; break;
+            case VK_DYNAMIC_STATE_DEPTH_CLAMP_ENABLE_EXT :
+                r.depth_clamp_enable = VK_FALSE; break;
+            default :
+                break;
+        }
+        if(desc.depth_stencil_info.has_value())
+        {
+            auto& ds = desc.depth_stencil_info.value();
+            if(state == VK_DYNAMIC_STATE_DEPTH_TEST_ENABLE_EXT)
+                ds.depth_test_enable = VK_FALSE;
+            else if(state == VK_DYNAMIC_STATE_DEPTH_WRITE_ENABLE_EXT)
+                ds.depth_write_enable = VK_FALSE;
+            else if(state == VK_DYNAMIC_STATE_DEPTH_COMPARE_OP_EXT)
+                ds.depth_compare_op = VK_COMPARE_OP_LESS;
+        }
+    }
+}
+
+//values for the states make_dynamic() took out of the pipeline, set on the command buffer per draw
+struct draw_state_t
+{
+    VkCullModeFlags          cull_mode = VK_CULL_MODE_NONE;
+    VkFrontFace             front_face = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+    VkPrimitiveTopology       topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+    VkBool32         primitive_restart = VK_FALSE;
+    VkBool32                depth_test = VK_FALSE;
+    VkBool32               depth_write = VK_FALSE;
+    VkCompareOp       depth_compare_op = VK_COMPARE_OP_LESS;
+    VkBool32                depth_bias = VK_FALSE;
+    VkBool32        rasterizer_discard = VK_FALSE;
+    VkPolygonMode         polygon_mode = VK_POLYGON_MODE_FILL;
+    VkBool32               depth_clamp = VK_FALSE;
+
+    //call before make_dynamic(), to keep drawing what the description describes
+    static draw_state_t from(const vk_handle::description::graphics_pipeline_desc& desc)
+    {
+        draw_state_t state{};
+        const auto& r = desc.rasterization_info;
+        state.cull_mode = r.cull_mode, state.front_face = r.front_face, state.polygon_mode = r.polygon_mode;
+        state.depth_bias = r.depth_bias_enable, state.rasterizer_discard = r.rasterization_discard, state.depth_clamp = r.depth_clamp_enable;
+        state.topology = desc.input_assembly_info.topology;
+        state.primitive_restart = desc.input_assembly_info.primitive_restart_enabled;
+        if(desc.depth_stencil_info.has_value())
+        {
+            const auto& ds = desc.depth_stencil_info.value();
+            state.depth_test = ds.depth_test_enable, state.depth_write = ds.depth_write_enable, state.depth_compare_op = ds.depth_compare_op;
+        }
+        return state;
+    }
+
+    //sets the states in the bound pipeline's dynamic state list, the rest are baked and left alone
+    void record(VkCommandBuffer cmd, std::span<const VkDynamicState> dynamic_states) const
+    {
+        for(auto state : dynamic_states)
+        {
+            switch(state)
+            {
+                case VK_DYNAMIC_STATE_CULL_MODE_EXT :
+                    vkCmdSetCullModeEXT(cmd, cull_mode); break;
+                case VK_DYNAMIC_STATE_FRONT_FACE_EXT :
+                    vkCmdSetFrontFaceEXT(cmd, front_face); break;
+                case VK_DYNAMIC_STATE_PRIMITIVE_TOPOLOGY_EXT :
+                    vkCmdSetPrimitiveTopologyEXT(cmd, topology); break;
+                case VK_DYNAMIC_STATE_DEPTH_TEST_ENABLE_EXT :
+                    vkCmdSetDepthTestEnableEXT(cmd, depth_test); break;
+                case VK_DYNAMIC_STATE_DEPTH_WRITE_ENABLE_EXT :
+                    vkCmdSetDepthWriteEnableEXT(cmd, depth_write); break;
+                case VK_DYNAMIC_STATE_DEPTH_COMPARE_OP_EXT :
+                    vkCmdSetDepthCompareOpEXT(cmd, depth_compare_op); break;
+                case VK_DYNAMIC_STATE_PRIMITIVE_RESTART_ENABLE_EXT :
+                    vkCmdSetPrimitiveRestartEnableEXT(cmd, primitive_restart); break;
+                case VK_DYNAMIC_STATE_DEPTH_BIAS_ENABLE_EXT :
+                    vkCmdSetDepthBiasEnableEXT(cmd, depth_bias); break;
+                case VK_DYNAMIC_STATE_RASTERIZER_DISCARD_ENABLE_EXT :
+                    vkCmdSetRasterizerDiscardEnableEXT(cmd, rasterizer_discard); break;
+                case VK_DYNAMIC_STATE_POLYGON_MODE_EXT :
+                    vkCmdSetPolygonModeEXT(cmd, polygon_mode); break;
+                case VK_DYNAMIC_STATE_DEPTH_CLAMP_ENABLE_EXT :
+                    vkCmdSetDepthClampEnableEXT(cmd, depth_clamp); break;
+                default :
+                    break;
+            }
+        }
+    }
+};
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <type_traits>
+
+//FNV-1a. Not cryptographic, but cheap and stable across runs, which is all our caches need.
+constexpr uint64_t HASH_SEED = 14695981039346656037ull;
+
+inline uint64_t hash_bytes(const void* data, size_t size, uint64_t seed = HASH_SEED)
+{
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    uint64_t hash = seed;
+    for(size_t i = 0; i < size; ++i)
+    {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+//only use this for scalars (no padding!)
+template<typename T> inline uint64_t hash_value(const T& value, uint64_t seed = HASH_SEED)
+{
+    static_assert(std::is_scalar_v<T>, "hash struct members one by one, padding bytes are garbage");
+    return hash_bytes(&value, sizeof(T), seed);
+}
@@ -0,0 +1,184 @@
+#pragma once
+
+#include "vulkan_handle.h"
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <memory>
+#include <deque>
+#include <optional>
+#include <unordered_map>
+#include <algorithm>
+#include <functional>
+
+/*
+    A pipeline that is compiled on a background thread. Until it is ready, get() returns the fallback
+    pipeline, or VK_NULL_HANDLE if there is none, in which case the draw should be skipped :
+
+        VkPipeline pipeline = async_pipeline.get();
+        if(pipeline != VK_NULL_HANDLE)
+        {
+            vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+            ...draw
+        }
+
+    The fallback must be compatible with the draw (same layout and vertex input) and must outlive this handle.
+*/
+class async_pipeline_t
+{
+public:
+    enum status : int
+    {
+        PENDING = 0,
+        READY   = 1,
+        FAILED  = 2,
+    };
+
+    VkPipeline get() const
+    {
+        if(state->status.load(std::memory_order_acquire) == READY)
+            return state->pipeline->handle[0];
+        return state->fallback;
+    }
+    status get_status() const {return static_cast<status>(state->status.load(std::memory_order_acquire));}
+    bool ready() const {return get_status() == READY;}
+
+private:
+    friend class pipeline_compiler_t;
+
+    struct shared_state
+    {
+        std::atomic<int>                              status{PENDING};
+        std::optional<vk_handle::graphics_pipeline>   pipeline;
+        VkPipeline                                    fallback;
+        vk_handle::description::graphics_pipeline_desc    desc;
+    };
+    async_pipeline_t(std::shared_ptr<shared_state> state) : state(state) {}
+
+    std::shared_ptr<shared_state> state;
+};
+
+/*
+    Worker threads that create pipelines off the render thread. vkCreateGraphicsPipelines is safe to call
+    concurrently, and pipeline caches are internally synchronized unless created with EXTERNALLY_SYNCHRONIZED.
+
+    Everything the descriptions point to (shader modules, layouts, renderpasses, specialization data) must
+    outlive the compiler. Jobs still queued when the compiler is destroyed are marked FAILED.
+*/
+class pipeline_compiler_t
+{
+public:
+    pipeline_compiler_t(uint32_t thread_count = 1)
+    {
+        thread_count = std::max(1u, thread_count);
+        for(uint32_t i = 0; i < thread_count; ++i)
+            workers.emplace_back([this](){work();});
+    }
+    ~pipeline_compiler_t()
+    {
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            stop = true;
+        }
+        wake.notify_all();
+        for(auto& worker : workers)
+            worker.join();
+        for(auto& job : jobs)
+            job->status.store(async_pipeline_t::FAILED, std::memory_order_release);
+    }
+    pipeline_compiler_t(const pipeline_compiler_t&) = delete;
+    pipeline_compiler_t& operator=(const pipeline_compiler_t&) = delete;
+
+    //called on the calling thread for every compile(), e.g. to record a pipeline_manifest_t
+    void set_compile_hook(std::function<void (vk_handle::description::graphics_pipeline_desc&)> hook)
+    {
+        compile_hook = hook;
+    }
+
+    //with a key function, compile() hands back the pipeline an earlier compile() with the same key started, as long as
+    //someone still holds it and it didn't fail. e.g. pipeline_manifest_t::key, so warm_up()'s pipelines get picked up
+    void set_key(std::function<uint64_t (const vk_handle::description::graphics_pipeline_desc&)> key)
+    {
+        key_fnc = key;
+    }
+
+    //never blocks. The returned handle is "not ready" until a worker has created the pipeline.
+    //a pipeline shared through set_key keeps the fallback it was first compiled with
+    async_pipeline_t compile(vk_handle::description::graphics_pipeline_desc desc, VkPipeline fallback = VK_NULL_HANDLE)
+    {
+        std::optional<uint64_t> key;
+        if(key_fnc)
+        {
+            key = key_fnc(desc);
+            std::lock_guard<std::mutex> guard(lock);
+            auto found = compiled.find(key.value());
+            if(found != compiled.end())
+                if(auto state = found->second.lock(); state && state->status.load(std::memory_order_acquire) != async_pipeline_t::FAILED)
+                    return async_pipeline_t(state);
+        }
+        if(compile_hook)
+            compile_hook(desc);
+        auto state = std::make_shared<async_pipeline_t::shared_state>();
+        state->fallback = fallback;
+        state->desc     = std::move(desc);
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            jobs.push_back(state);
+            if(key.has_value())
+                compiled[key.value()] = state;
+        }
+        wake.notify_one();
+        return async_pipeline_t(state);
+    }
+    size_t pending() const
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        return jobs.size() + in_progress;
+    }
+
+private:
+    void work()
+    {
+        while(true)
+        {
+            std::shared_ptr<async_pipeline_t::shared_state> job;
+            {
+                std::unique_lock<std::mutex> guard(lock);
+                wake.wait(guard, [this](){return stop || !jobs.empty();});
+                if(stop)
+                    return;
+                job = std::move(jobs.front());
+                jobs.pop_front();
+                in_progress++;
+            }
+            //skip it if the handle was dropped while queued
+            if(job.use_count() > 1)
+            {
+                try
+                {
+                    job->pipeline.emplace(std::vector<vk_handle::description::graphics_pipeline_desc>{job->desc});
+                    job->status.store(async_pipeline_t::READY, std::memory_order_release);
+                }
+                catch(const std::exception&)
+                {
+                    INFORM_ERR("WARNING : async pipeline compilation failed, keeping the fallback");
+                    job->status.store(async_pipeline_t::FAILED, std::memory_order_release);
+                }
+            }
+            std::lock_guard<std::mutex> guard(lock);
+            in_progress--;
+        }
+    }
+
+    mutable std::mutex                                              lock;
+    std::condition_variable                                         wake;
+    std::deque<std::shared_ptr<async_pipeline_t::shared_state>>     jobs;
+    uint32_t                                                 in_progress = 0;
+    bool                                                          stop = false;
+    std::function<void (vk_handle::description::graphics_pipeline_desc&)> compile_hook;
+    std::function<uint64_t (const vk_handle::description::graphics_pipeline_desc&)> key_fnc;
+    std::unordered_map<uint64_t, std::weak_ptr<async_pipeline_t::shared_state>>      compiled;
+    std::vector<std::thread>                                     workers;
+};
@@ -0,0 +1,210 @@
+#pragma once
+
+#include "vulkan_handle.h"
+#include "vulkan_data_getters.h"
+#include "pipeline_compiler.h"
+#include "hash.h"
+
+#include <unordered_map>
+#include <cstring>
+#include <array>
+
+/*
+    Builds graphics pipelines out of four separately cached libraries (VK_EXT_graphics_pipeline_library) :
+
+        vertex input      : vertex_input_info, input_assembly_info
+        pre-rasterization : every non-fragment stage, viewport_state_info, rasterization_info, layout
+        fragment shader   : the fragment stage, depth_stencil_info, multisample_info, layout
+        fragment output   : color_blend_info, multisample_info
+
+    Each part is hashed on its own state only, so changing blend state reuses the compiled shader libraries and
+    the pipeline is produced by a (fast) link. When given a compiler, an optimized link is also queued in the
+    background and replaces the fast one once ready. Devices without graphicsPipelineLibraryFastLinking don't promise
+    an unoptimized link is any cheaper, there the one link made is the optimized one and nothing is queued.
+
+    Without the extension, get() falls back to compiling complete pipelines, cached by the combined hash.
+    The optimizer's queued links reference the libraries, so it has to be destroyed before this cache.
+*/
+class pipeline_library_cache_t
+{
+public:
+    pipeline_library_cache_t(const vk_handle::device& device, VkPipelineCache cache = VK_NULL_HANDLE,
+    pipeline_compiler_t* optimizer = nullptr) : device(device), cache(cache), optimizer(optimizer),
+    supported(device.description.graphics_pipeline_library_features.has_value()),
+    fast_linking(supported && vk_handle::data_getters::physical_device::get_graphics_pipeline_library_properties(
+    device.description.phys_device).graphicsPipelineLibraryFastLinking)
+    {
+    }
+
+    //the description must be a complete one, library_parts and libraries are set here
+    VkPipeline get(vk_handle::description::graphics_pipeline_desc desc)
+    {
+        desc.parent = device;
+        desc.pipeline_cache = cache;
+        std::array<uint64_t, PART_COUNT> keys = get_part_keys(desc);
+        uint64_t key = hash_bytes(keys.data(), keys.size() * sizeof(uint64_t));
+
+        auto itr = linked.find(key);
+        if(itr != linked.end())
+            return itr->second.get();
+
+        if(!supported)
+        {
+            auto result = linked.try_emplace(key, vk_handle::graphics_pipeline({desc}));
+            return result.first->second.get();
+        }
+
+        std::vector<VkPipeline> parts;
+        parts.reserve(PART_COUNT);
+        for(uint32_t i = 0; i < PART_COUNT; ++i)
+            parts.push_back(get_library(desc, PART_FLAGS[i], keys[i]));
+
+        vk_handle::description::graphics_pipeline_desc link_desc{};
+        link_desc.parent          = device;
+        link_desc.pipeline_layout = desc.pipeline_layout;
+        link_desc.pipeline_cache  = cache;
+        link_desc.libraries       = parts;
+        if(!fast_linking)
+            link_desc.flags = VK_PIPELINE_CREATE_LINK_TIME_OPTIMIZATION_BIT_EXT;
+        auto result = linked.try_emplace(key, vk_handle::graphics_pipeline({link_desc}));
+        auto& pipeline = result.first->second;
+
+        if(optimizer != nullptr && fast_linking)
+        {
+            link_desc.flags = VK_PIPELINE_CREATE_LINK_TIME_OPTIMIZATION_BIT_EXT;
+            pipeline.optimized = optimizer->compile(link_desc, pipeline.fast.handle[0]);
+        }
+        return pipeline.get();
+    }
+    size_t library_count() const {return libraries.size();}
+    size_t pipeline_count() const {return linked.size();}
+    bool links() const {return supported;}
+    bool links_fast() const {return fast_linking;}
+
+private:
+    static constexpr uint32_t PART_COUNT = 4;
+    static constexpr VkGraphicsPipelineLibraryFlagsEXT PART_FLAGS[PART_COUNT] = {
+        VK_GRAPHICS_PIPELINE_LIBRARY_VERTEX_INPUT_INTERFACE_BIT_EXT,
+        VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT,
+        VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT,
+        VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_OUTPUT_INTERFACE_BIT_EXT
+    };
+
+    struct linked_pipeline
+    {
+        vk_handle::graphics_pipeline            fast;
+        std::optional<async_pipeline_t>    optimized;
+
+        linked_pipeline(vk_handle::graphics_pipeline&& fast) : fast(std::move(fast)) {}
+        VkPipeline get() const {return optimized.has_value() ? optimized->get() : fast.handle[0];}
+    };
+
+    VkPipeline get_library(const vk_handle::description::graphics_pipeline_desc& desc, VkGraphicsPipelineLibraryFlagsEXT part,
+    uint64_t key)
+    {
+        auto itr = libraries.find(key);
+        if(itr != libraries.end())
+            return itr->second.handle[0];
+        auto library_desc = desc;
+        library_desc.library_parts = part;
+        auto result = libraries.try_emplace(key, std::vector<vk_handle::description::graphics_pipeline_desc>{library_desc});
+        return result.first->second.handle[0];
+    }
+
+    static uint64_t hash_stage(const vk_handle::description::shader_stage_desc& stage, uint64_t hash)
+    {
+        hash = hash_value(stage.module, hash_value(stage.stage, hash));
+        hash = hash_bytes(stage.entry_point, std::strlen(stage.entry_point), hash);
+        if(stage.specialization_info.has_value())
+        {
+            const auto& info = stage.specialization_info.value();
+            for(uint32_t i = 0; i < info.mapEntryCount; ++i)
+            {
+                hash = hash_value(info.pMapEntries[i].constantID, hash);
+                hash = hash_value(info.pMapEntries[i].offset, hash);
+                hash = hash_value(info.pMapEntries[i].size, hash);
+            }
+            hash = hash_bytes(info.pData, info.dataSize, hash);
+        }
+        return hash;
+    }
+    static uint64_t hash_multisample(const vk_handle::description::multisample_desc& ms, uint64_t hash)
+    {
+        return hash_value(ms.rasterization_samples, hash_value(ms.sample_shading_enable, hash));
+    }
+    //one key per entry of PART_FLAGS, each covering only the state that goes into that library
+    static std::array<uint64_t, PART_COUNT> get_part_keys(vk_handle::description::graphics_pipeline_desc& desc)
+    {
+        uint64_t common = hash_value(desc.renderpass, hash_value(desc.subpass_index));
+        for(auto state : desc.dynamic_state_info.dynamic_state_list)
+            common = hash_value(state, common);
+        if(desc.rendering.has_value())
+        {
+            const auto& rendering = desc.rendering.value();
+            common = hash_bytes(rendering.color_formats.data(), rendering.color_formats.size() * sizeof(VkFormat), common);
+            common = hash_value(rendering.depth_format.value_or(VK_FORMAT_UNDEFINED), common);
+            common = hash_value(rendering.stencil_format.value_or(VK_FORMAT_UNDEFINED), common);
+            common = hash_value(rendering.view_mask, common);
+        }
+
+        std::array<uint64_t, PART_COUNT> keys;
+        {
+            auto vi = desc.vertex_input_info.get_info();
+            uint64_t hash = hash_value(PART_FLAGS[0], common);
+            hash = hash_bytes(vi.pVertexBindingDescriptions, vi.vertexBindingDescriptionCount * sizeof(VkVertexInputBindingDescription), hash);
+            hash = hash_bytes(vi.pVertexAttributeDescriptions, vi.vertexAttributeDescriptionCount * sizeof(VkVertexInputAttributeDescription),
+            hash);
+            hash = hash_value(vi.flags, hash);
+            hash = hash_value(desc.input_assembly_info.topology, hash);
+            keys[0] = hash_value(desc.input_assembly_info.primitive_restart_enabled, hash);
+        }
+        {
+            uint64_t hash = hash_value(PART_FLAGS[1], hash_value(desc.pipeline_layout, common));
+            for(const auto& stage : desc.shader_stages_info)
+                if(stage.stage != VK_SHADER_STAGE_FRAGMENT_BIT)
+                    hash = hash_stage(stage, hash);
+            const auto& vp = desc.viewport_state_info;
+            hash = hash_bytes(vp.viewports.data(), vp.viewports.size() * sizeof(VkViewport), hash);
+            hash = hash_bytes(vp.scissors.data(), vp.scissors.size() * sizeof(VkRect2D), hash);
+            const auto& r = desc.rasterization_info;
+            hash = hash_value(r.rasterization_discard, hash_value(r.polygon_mode, hash_value(r.line_width, hash)));
+            hash = hash_value(r.front_face, hash_value(r.cull_mode, hash_value(r.depth_clamp_enable, hash)));
+            hash = hash_value(r.depth_bias_enable, hash_value(r.depth_bias_clamp, hash));
+            keys[1] = hash_value(r.depth_bias_slope_factor, hash_value(r.depth_bias_constant_factor, hash));
+        }
+        {
+            uint64_t hash = hash_value(PART_FLAGS[2], hash_value(desc.pipeline_layout, common));
+            for(const auto& stage : desc.shader_stages_info)
+                if(stage.stage == VK_SHADER_STAGE_FRAGMENT_BIT)
+                    hash = hash_stage(stage, hash);
+            hash = hash_value(desc.depth_stencil_info.has_value(), hash);
+            if(desc.depth_stencil_info.has_value())
+            {
+                const auto& ds = desc.depth_stencil_info.value();
+                hash = hash_value(ds.depth_compare_op, hash_value(ds.depth_write_enable, hash_value(ds.depth_test_enable, hash)));
+            }
+            keys[2] = hash_multisample(desc.multisample_info, hash);
+        }
+        {
+            const auto& cb = desc.color_blend_info;
+            uint64_t hash = hash_value(PART_FLAGS[3], common);
+            hash = hash_value(cb.logic_op_enabled, hash);
+            if(cb.logic_op_enabled)
+                hash = hash_value(cb.logic_op, hash);
+            if(cb.blend_constants.has_value())
+                hash = hash_bytes(cb.blend_constants.value().data(), 4 * sizeof(float), hash);
+            hash = hash_bytes(cb.attachment_states.data(), cb.attachment_states.size() * sizeof(VkPipelineColorBlendAttachmentState), hash);
+            keys[3] = hash_multisample(desc.multisample_info, hash);
+        }
+        return keys;
+    }
+
+    VkDevice                   device;
+    VkPipelineCache             cache;
+    pipeline_compiler_t*    optimizer;
+    bool                    supported;
+    bool                 fast_linking;
+
+    std::unordered_map<uint64_t, vk_handle::graphics_pipeline>  libraries;
+    std::unordered_map<uint64_t, linked_pipeline>                 linked;
+};
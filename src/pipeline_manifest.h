@@ -0,0 +1,555 @@
+#pragma once
+
+#include "vulkan_handle.h"
+#include "pipeline_compiler.h"
+#include "read_file.h"
+#include "hash.h"
+
+#include <unordered_map>
+#include <unordered_set>
+#include <deque>
+#include <cstring>
+#include <fstream>
+#include <type_traits>
+
+/*
+    Remembers every graphics pipeline created in a session so the next session can compile them up front :
+
+        manifest.set_renderpass(0, main_pass);
+        manifest.set_layout(0, layout);
+        manifest.add_shader(vertex_shader), manifest.add_shader(fragment_shader);
+        compiler.set_compile_hook([&](auto& desc){manifest.record(desc);});
+        ...
+        manifest.save("pipelines.manifest");
+
+    and at startup, during a loading screen :
+
+        manifest.load("pipelines.manifest");
+        compiler.set_key([&](const auto& desc){return manifest.key(desc);});
+        auto warm = manifest.warm_up(device, compiler, cache);   //queued on the compiler threads
+
+    With the key set, compiling one of those pipelines again returns the one already queued.
+
+    Handles can't be saved, so renderpasses and layouts are stored as ids the application assigns, and shader
+    modules by the hash of their byte code (each module is stored once). Pipelines whose renderpass or layout
+    has no id, or whose shaders weren't added, are skipped on save. Pipelines made for dynamic rendering have
+    VK_NULL_HANDLE as their renderpass, which needs an id like any other.
+
+    The file is only meant to be read back by the same build on the same machine, structs are written as is.
+    Together with a pipeline cache this takes pipeline compiles off first use entirely.
+*/
+class pipeline_manifest_t
+{
+public:
+    static constexpr uint32_t MAGIC   = 0x464D4C50; //"PLMF"
+    static constexpr uint32_t VERSION = 4;
+
+    void set_renderpass(uint32_t id, VkRenderPass renderpass)
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        renderpass_ids[renderpass] = id, renderpasses[id] = renderpass;
+    }
+    void set_layout(uint32_t id, VkPipelineLayout layout)
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        layout_ids[layout] = id, layouts[id] = layout;
+    }
+    void add_shader(const vk_handle::shader_module& shader)
+    {
+        const auto& desc = shader.description;
+        uint64_t hash = hash_bytes(desc.byte_code.data(), desc.byte_code.size());
+        std::lock_guard<std::mutex> guard(lock);
+        module_hashes[shader] = hash;
+        modules.try_emplace(hash, module_record{desc.stage, desc.byte_code});
+    }
+
+    //everything is copied out of the description, it doesn't need to stay alive.
+    //library parts and linked pipelines are skipped, they can't be replayed on their own
+    void record(vk_handle::description::graphics_pipeline_desc& desc)
+    {
+        if(desc.library_parts.has_value() || !desc.libraries.empty())
+            return;
+        auto pending = make_record(desc);
+        std::lock_guard<std::mutex> guard(lock);
+        if(recorded_keys.insert(key_locked(pending)).second)
+            recorded.push_back(std::move(pending));
+    }
+    //shaders count by the hash of their byte code, so what warm_up() queued and the same pipeline described again
+    //by the application share a key. See pipeline_compiler_t::set_key
+    uint64_t key(const vk_handle::description::graphics_pipeline_desc& desc) const
+    {
+        auto pending = make_record(desc);
+        std::lock_guard<std::mutex> guard(lock);
+        return key_locked(pending);
+    }
+
+    bool save(const char* path) const
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        writer out;
+        out.pod(MAGIC), out.pod(VERSION);
+
+        std::vector<const pending_record*> resolvable;
+        for(const auto& pipeline : recorded)
+            if(resolvable_locked(pipeline))
+                resolvable.push_back(&pipeline);
+            else
+                INFORM_ERR("WARNING : pipeline manifest skips a pipeline with an unknown renderpass, layout or shader");
+
+        out.pod(static_cast<uint32_t>(modules.size()));
+        for(const auto& [hash, module] : modules)
+        {
+            out.pod(hash), out.pod(module.stage);
+            out.array(module.byte_code);
+        }
+        //different module handles can share byte code, so dedupe again on what actually gets written
+        std::unordered_set<uint64_t> written;
+        std::vector<std::vector<uint8_t>> entries;
+        auto add_entry = [&](std::vector<uint8_t> bytes)
+        {
+            if(written.insert(hash_bytes(bytes.data(), bytes.size())).second)
+                entries.push_back(std::move(bytes));
+        };
+        for(const auto* pipeline : resolvable)
+        {
+            writer entry;
+            entry.pod(renderpass_ids.at(pipeline->renderpass)), entry.pod(layout_ids.at(pipeline->layout)), entry.pod(pipeline->subpass);
+            entry.pod(static_cast<uint32_t>(pipeline->stages.size()));
+            for(const auto& s : pipeline->stages)
+            {
+                entry.pod(module_hashes.at(s.module)), entry.pod(s.stage);
+                entry.string(s.entry_point);
+                entry.array(s.map_entries), entry.array(s.data);
+            }
+            entry.array(pipeline->state);
+            add_entry(std::move(entry.bytes));
+        }
+        //everything from the last manifest is kept, whether or not it was created this session
+        for(const auto& bytes : carried_over)
+            add_entry(bytes);
+
+        out.pod(static_cast<uint32_t>(entries.size()));
+        for(const auto& bytes : entries)
+            out.bytes.insert(out.bytes.end(), bytes.begin(), bytes.end());
+
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        if(!file.is_open())
+            return false;
+        file.write(reinterpret_cast<const char*>(out.bytes.data()), out.bytes.size());
+        return file.good();
+    }
+
+    //returns false if the file is missing or from a different build, the manifest is left empty then
+    bool load(const char* path)
+    {
+        std::vector<char> bytes;
+        if(!read_binary_file(path, bytes))
+            return false;
+        return load(bytes, path);
+    }
+    //same, for a file that was read ahead of time. path is only used in warnings
+    bool load(const std::vector<char>& bytes, const char* path)
+    {
+        if(bytes.empty())
+            return false;
+        std::lock_guard<std::mutex> guard(lock);
+        loaded.clear();
+        carried_over.clear();
+
+        reader in{reinterpret_cast<const uint8_t*>(bytes.data()), bytes.size()};
+        if(in.pod<uint32_t>() != MAGIC || in.pod<uint32_t>() != VERSION)
+        {
+            INFORM_ERR("WARNING : " << path << " is not a pipeline manifest of this version, ignoring it");
+            return false;
+        }
+        uint32_t module_count = in.pod<uint32_t>();
+        for(uint32_t i = 0; i < module_count && in.ok; ++i)
+        {
+            uint64_t hash = in.pod<uint64_t>();
+            auto stage    = in.pod<VkShaderStageFlagBits>();
+            modules.try_emplace(hash, module_record{stage, in.array<char>()});
+        }
+        uint32_t pipeline_count = in.pod<uint32_t>();
+        for(uint32_t i = 0; i < pipeline_count && in.ok; ++i)
+        {
+            size_t begin = in.pos;
+            loaded_record pipeline{};
+            pipeline.renderpass = in.pod<uint32_t>(), pipeline.layout = in.pod<uint32_t>(), pipeline.subpass = in.pod<uint32_t>();
+            uint32_t stage_count = in.pod<uint32_t>();
+            for(uint32_t j = 0; j < stage_count && in.ok; ++j)
+            {
+                loaded_stage s{};
+                s.module = in.pod<uint64_t>(), s.stage = in.pod<VkShaderStageFlagBits>();
+                s.entry_point = in.string();
+                s.map_entries = in.array<VkSpecializationMapEntry>(), s.data = in.array<uint8_t>();
+                pipeline.stages.push_back(std::move(s));
+            }
+            pipeline.state = in.array<uint8_t>();
+            if(!in.ok)
+                break;
+            carried_over.emplace_back(in.data + begin, in.data + in.pos);
+            loaded.push_back(std::move(pipeline));
+        }
+        if(!in.ok)
+        {
+            INFORM_ERR("WARNING : " << path << " is truncated, ignoring it");
+            loaded.clear();
+            carried_over.clear();
+            return false;
+        }
+        return true;
+    }
+
+    /*
+        Queues every loaded pipeline on the compiler. Renderpasses and layouts must have been set for the ids in
+        the file. The manifest owns the shader modules it creates, so it must outlive the compiler's work.
+        Wait on compiler.pending() == 0 before the first frame, or keep drawing a loading screen meanwhile.
+    */
+    std::vector<async_pipeline_t> warm_up(VkDevice device, pipeline_compiler_t& compiler, VkPipelineCache cache = VK_NULL_HANDLE)
+    {
+        std::vector<vk_handle::description::graphics_pipeline_desc> descs;
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            descs = get_loaded_descs(device, cache);
+        }
+        std::vector<async_pipeline_t> pipelines;
+        for(auto& desc : descs)
+            pipelines.push_back(compiler.compile(desc));
+        return pipelines;
+    }
+    size_t recorded_count() const
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        return recorded.size();
+    }
+
+private:
+    std::vector<vk_handle::description::graphics_pipeline_desc> get_loaded_descs(VkDevice device, VkPipelineCache cache)
+    {
+        std::vector<vk_handle::description::graphics_pipeline_desc> descs;
+        for(auto& pipeline : loaded)
+        {
+            auto renderpass = renderpasses.find(pipeline.renderpass);
+            auto layout     = layouts.find(pipeline.layout);
+            if(renderpass == renderpasses.end() || layout == layouts.end())
+                continue;
+            vk_handle::description::graphics_pipeline_desc desc{};
+            desc.parent          = device;
+            desc.renderpass      = renderpass->second;
+            desc.pipeline_layout = layout->second;
+            desc.subpass_index   = pipeline.subpass;
+            desc.pipeline_cache  = cache;
+
+            reader state{pipeline.state.data(), pipeline.state.size()};
+            read_state(state, desc);
+            bool complete = state.ok;
+            for(auto& s : pipeline.stages)
+            {
+                VkShaderModule module = get_module(device, s.module);
+                if(module == VK_NULL_HANDLE)
+                {
+                    complete = false;
+                    break;
+                }
+                vk_handle::description::shader_stage_desc stage{};
+                stage.module      = module;
+                stage.stage       = s.stage;
+                stage.entry_point = s.entry_point.c_str();
+                if(!s.map_entries.empty())
+                    stage.specialization_info = VkSpecializationInfo{static_cast<uint32_t>(s.map_entries.size()), s.map_entries.data(),
+                    s.data.size(), s.data.data()};
+                desc.shader_stages_info.push_back(stage);
+            }
+            if(!complete)
+            {
+                INFORM_ERR("WARNING : skipping a damaged pipeline manifest entry");
+                continue;
+            }
+            descs.push_back(std::move(desc));
+        }
+        return descs;
+    }
+
+    struct module_record
+    {
+        VkShaderStageFlagBits   stage;
+        std::vector<char>   byte_code;
+    };
+    struct stage_record
+    {
+        VkShaderModule                          module;
+        VkShaderStageFlagBits                    stage;
+        std::string                        entry_point;
+        std::vector<VkSpecializationMapEntry> map_entries;
+        std::vector<uint8_t>                      data;
+    };
+    struct pending_record
+    {
+        VkRenderPass           renderpass;
+        VkPipelineLayout           layout;
+        uint32_t                  subpass;
+        std::vector<stage_record>  stages;
+        std::vector<uint8_t>        state;  //everything that isn't a handle, see write_state
+    };
+    struct loaded_stage
+    {
+        uint64_t                                module;
+        VkShaderStageFlagBits                    stage;
+        std::string                        entry_point;
+        std::vector<VkSpecializationMapEntry> map_entries;
+        std::vector<uint8_t>                      data;
+    };
+    struct loaded_record
+    {
+        uint32_t renderpass, layout, subpass;
+        std::vector<loaded_stage> stages;
+        std::vector<uint8_t>       state;
+    };
+
+    struct writer
+    {
+        std::vector<uint8_t> bytes;
+        template<typename T> void pod(const T& value)
+        {
+            static_assert(std::is_trivially_copyable_v<T>);
+            const uint8_t* ptr = reinterpret_cast<const uint8_t*>(&value);
+            bytes.insert(bytes.end(), ptr, ptr + sizeof(T));
+        }
+        template<typename T> void array(const T* data, size_t count)
+        {
+            static_assert(std::is_trivially_copyable_v<T>);
+            pod(static_cast<uint32_t>(count));
+            const uint8_t* ptr = reinterpret_cast<const uint8_t*>(data);
+            bytes.insert(bytes.end(), ptr, ptr + count * sizeof(T));
+        }
+        template<typename T> void array(const std::vector<T>& data) {array(data.data(), data.size());}
+        template<typename T> void array(std::span<const T> data) {array(data.data(), data.size());}
+        void string(const std::string& str) {array(str.data(), str.size());}
+    };
+    struct reader
+    {
+        const uint8_t* data;
+        size_t         size;
+        size_t          pos = 0;
+        bool             ok = true;
+
+        template<typename T> T pod()
+        {
+            T value{};
+            if(!ok || pos + sizeof(T) > size)
+            {
+                ok = false;
+                return value;
+            }
+            std::memcpy(&value, data + pos, sizeof(T));
+            pos += sizeof(T);
+            return value;
+        }
+        template<typename T> std::vector<T> array()
+        {
+            uint32_t count = pod<uint32_t>();
+            if(!ok || pos + size_t(count) * sizeof(T) > size)
+            {
+                ok = false;
+                return {};
+            }
+            std::vector<T> values(count);
+            std::memcpy(values.data(), data + pos, count * sizeof(T));
+            pos += count * sizeof(T);
+            return values;
+        }
+        std::string string()
+        {
+            auto chars = array<char>();
+            return std::string(chars.begin(), chars.end());
+        }
+    };
+
+    //fixed function state, in the same order in both functions
+    static void write_state(writer& out, const vk_handle::description::graphics_pipeline_desc& desc)
+    {
+        const auto& vi = desc.vertex_input_info;
+        if(vi.static_binding_descriptions.empty())
+            out.array(vi.binding_descriptions);
+        else
+            out.array(vi.static_binding_descriptions);
+        if(vi.static_attrib_descriptions.empty())
+            out.array(vi.attrib_descriptions);
+        else
+            out.array(vi.static_attrib_descriptions);
+        out.pod(vi.flags.value_or(0));
+
+        out.pod(desc.input_assembly_info.topology), out.pod(desc.input_assembly_info.primitive_restart_enabled);
+        out.array(desc.viewport_state_info.viewports), out.array(desc.viewport_state_info.scissors);
+        //field by field, the create info's sType, pNext and padding have no business in the file
+        const auto& r = desc.rasterization_info;
+        out.pod(r.rasterization_discard), out.pod(r.polygon_mode), out.pod(r.line_width), out.pod(r.front_face);
+        out.pod(r.cull_mode), out.pod(r.depth_clamp_enable), out.pod(r.depth_bias_enable), out.pod(r.depth_bias_clamp);
+        out.pod(r.depth_bias_slope_factor), out.pod(r.depth_bias_constant_factor);
+        out.pod(desc.multisample_info.rasterization_samples), out.pod(desc.multisample_info.sample_shading_enable);
+        out.pod(static_cast<uint32_t>(desc.depth_stencil_info.has_value()));
+        if(desc.depth_stencil_info.has_value())
+        {
+            const auto& ds = desc.depth_stencil_info.value();
+            out.pod(ds.depth_test_enable), out.pod(ds.depth_write_enable), out.pod(ds.depth_compare_op);
+        }
+
+        const auto& cb = desc.color_blend_info;
+        out.pod(cb.logic_op_enabled), out.pod(cb.logic_op);
+        out.pod(static_cast<uint32_t>(cb.blend_constants.has_value()));
+        out.pod(cb.blend_constants.value_or(std::array<float, 4>{}));
+        out.array(cb.attachment_states);
+        out.array(desc.dynamic_state_info.dynamic_state_list);
+
+        out.pod(static_cast<uint32_t>(desc.rendering.has_value()));
+        if(desc.rendering.has_value())
+        {
+            const auto& rendering = desc.rendering.value();
+            out.array(rendering.color_formats);
+            out.pod(rendering.depth_format.value_or(VK_FORMAT_UNDEFINED));
+            out.pod(rendering.stencil_format.value_or(VK_FORMAT_UNDEFINED));
+            out.pod(rendering.view_mask);
+        }
+    }
+    static void read_state(reader& in, vk_handle::description::graphics_pipeline_desc& desc)
+    {
+        auto& vi = desc.vertex_input_info;
+        vi.binding_descriptions = in.array<VkVertexInputBindingDescription>();
+        vi.attrib_descriptions  = in.array<VkVertexInputAttributeDescription>();
+        vi.flags = in.pod<VkPipelineVertexInputStateCreateFlags>();
+
+        desc.input_assembly_info.topology = in.pod<VkPrimitiveTopology>();
+        desc.input_assembly_info.primitive_restart_enabled = in.pod<VkBool32>();
+        desc.viewport_state_info.viewports = in.array<VkViewport>();
+        desc.viewport_state_info.scissors  = in.array<VkRect2D>();
+
+        auto& r = desc.rasterization_info;
+        r.rasterization_discard      = in.pod<VkBool32>();
+        r.polygon_mode               = in.pod<VkPolygonMode>();
+        r.line_width                 = in.pod<float>();
+        r.front_face                 = in.pod<VkFrontFace>();
+        r.cull_mode                  = in.pod<VkCullModeFlags>();
+        r.depth_clamp_enable         = in.pod<VkBool32>();
+        r.depth_bias_enable          = in.pod<VkBool32>();
+        r.depth_bias_clamp           = in.pod<float>();
+        r.depth_bias_slope_factor    = in.pod<float>();
+        r.depth_bias_constant_factor = in.pod<float>();
+
+        desc.multisample_info.rasterization_samples = in.pod<VkSampleCountFlagBits>();
+        desc.multisample_info.sample_shading_enable = in.pod<VkBool32>();
+        if(in.pod<uint32_t>())
+        {
+            vk_handle::description::depth_stencil_desc ds{};
+            ds.depth_test_enable  = in.pod<VkBool32>();
+            ds.depth_write_enable = in.pod<VkBool32>();
+            ds.depth_compare_op   = in.pod<VkCompareOp>();
+            desc.depth_stencil_info = ds;
+        }
+
+        auto& cb = desc.color_blend_info;
+        cb.logic_op_enabled = in.pod<VkBool32>();
+        cb.logic_op         = in.pod<VkLogicOp>();
+        bool has_constants  = in.pod<uint32_t>();
+        auto constants      = in.pod<std::array<float, 4>>();
+        if(has_constants)
+            cb.blend_constants = constants;
+        cb.attachment_states = in.array<VkPipelineColorBlendAttachmentState>();
+        desc.dynamic_state_info.dynamic_state_list = in.array<VkDynamicState>();
+
+        if(in.pod<uint32_t>())
+        {
+            vk_handle::description::rendering_desc rendering{};
+            rendering.color_formats = in.array<VkFormat>();
+            auto depth   = in.pod<VkFormat>();
+            auto stencil = in.pod<VkFormat>();
+            if(depth != VK_FORMAT_UNDEFINED)
+                rendering.depth_format = depth;
+            if(stencil != VK_FORMAT_UNDEFINED)
+                rendering.stencil_format = stencil;
+            rendering.view_mask = in.pod<uint32_t>();
+            desc.rendering = rendering;
+        }
+    }
+
+    static pending_record make_record(const vk_handle::description::graphics_pipeline_desc& desc)
+    {
+        pending_record pending{};
+        pending.renderpass = desc.renderpass, pending.layout = desc.pipeline_layout, pending.subpass = desc.subpass_index;
+        for(const auto& stage : desc.shader_stages_info)
+        {
+            stage_record s{};
+            s.module = stage.module;
+            s.stage  = stage.stage;
+            s.entry_point = stage.entry_point;
+            if(stage.specialization_info.has_value())
+            {
+                const auto& info = stage.specialization_info.value();
+                s.map_entries.assign(info.pMapEntries, info.pMapEntries + info.mapEntryCount);
+                const uint8_t* data = static_cast<const uint8_t*>(info.pData);
+                s.data.assign(data, data + info.dataSize);
+            }
+            pending.stages.push_back(std::move(s));
+        }
+        writer state;
+        write_state(state, desc);
+        pending.state = std::move(state.bytes);
+        return pending;
+    }
+    //modules the manifest doesn't know of count by their handle
+    uint64_t key_locked(const pending_record& pipeline) const
+    {
+        uint64_t key = hash_value(pipeline.renderpass, hash_value(pipeline.layout, hash_value(pipeline.subpass)));
+        for(const auto& s : pipeline.stages)
+        {
+            auto module = module_hashes.find(s.module);
+            key = module == module_hashes.end() ? hash_value(s.module, key) : hash_value(module->second, key);
+            key = hash_value(s.stage, key);
+            key = hash_bytes(s.entry_point.data(), s.entry_point.size(), key);
+            key = hash_bytes(s.data.data(), s.data.size(), key);
+        }
+        return hash_bytes(pipeline.state.data(), pipeline.state.size(), key);
+    }
+    bool resolvable_locked(const pending_record& pipeline) const
+    {
+        if(!renderpass_ids.contains(pipeline.renderpass) || !layout_ids.contains(pipeline.layout))
+            return false;
+        for(const auto& s : pipeline.stages)
+            if(!module_hashes.contains(s.module))
+                return false;
+        return true;
+    }
+    VkShaderModule get_module(VkDevice device, uint64_t hash)
+    {
+        auto created = created_modules.find(hash);
+        if(created != created_modules.end())
+            return created->second;
+        auto module = modules.find(hash);
+        if(module == modules.end())
+            return VK_NULL_HANDLE;
+        vk_handle::description::shader_module_desc desc{};
+        desc.parent    = device;
+        desc.stage     = module->second.stage;
+        desc.byte_code = module->second.byte_code;
+        auto& handle = owned_modules.emplace_back(desc);
+        created_modules[hash] = handle;
+        module_hashes[handle] = hash;
+        return handle;
+    }
+
+    mutable std::mutex lock;
+
+    std::unordered_map<VkRenderPass, uint32_t>     renderpass_ids;
+    std::unordered_map<uint32_t, VkRenderPass>       renderpasses;
+    std::unordered_map<VkPipelineLayout, uint32_t>     layout_ids;
+    std::unordered_map<uint32_t, VkPipelineLayout>        layouts;
+    std::unordered_map<VkShaderModule, uint64_t>    module_hashes;
+    std::unordered_map<uint64_t, module_record>           modules;
+
+    std::unordered_set<uint64_t>                    recorded_keys;
+    std::vector<pending_record>                          recorded;
+    std::vector<loaded_record>                             loaded;
+    std::vector<std::vector<uint8_t>>                carried_over;
+
+    std::unordered_map<uint64_t, VkShaderModule>  created_modules;
+    std::deque<vk_handle::shader_module>            owned_modules;
+};
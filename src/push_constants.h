@@ -0,0 +1,60 @@
+#pragma once
+
+#include "vulkan_handle_description.h"
+#include "vulkan_data_getters.h"
+
+#include <type_traits>
+
+//the spec guarantees at least this many bytes of push constants on every device
+constexpr uint32_t MIN_PUSH_CONSTANTS_SIZE = 128;
+
+/*
+    Typed per-draw push constant block :
+
+        struct draw_data {glm::mat4 model; uint32_t material; uint32_t pad[3];};
+        typedef push_constant_t<draw_data, VK_SHADER_STAGE_VERTEX_BIT> draw_push;
+
+        layout_desc.push_constant_ranges.push_back(draw_push::range);
+        ...
+        draw_push pc(pipeline_layout, phys_device);
+        pc.push(cmd, data);
+
+    The size is known at compile time, so blocks within the guaranteed 128 bytes never touch the device limits.
+    Bigger blocks are checked against maxPushConstantsSize once, on construction, never per push.
+*/
+template<typename T, VkShaderStageFlags stages = VK_SHADER_STAGE_ALL_GRAPHICS, uint32_t offset = 0>
+class push_constant_t
+{
+    static_assert(std::is_trivially_copyable_v<T>, "push constants are memcpy`d, T must be trivially copyable");
+    static_assert(sizeof(T) % 4 == 0, "push constant size must be a multiple of 4");
+    static_assert(offset % 4 == 0, "push constant offset must be a multiple of 4");
+public:
+    static constexpr uint32_t size = sizeof(T);
+    static constexpr VkPushConstantRange range{stages, offset, size};
+    static constexpr bool guaranteed = offset + size <= MIN_PUSH_CONSTANTS_SIZE;
+
+    static bool supported(VkPhysicalDevice phys_device)
+    {
+        if constexpr (guaranteed)
+            return true;
+        return offset + size <= vk_handle::data_getters::physical_device::get_properties(phys_device).limits.maxPushConstantsSize;
+    }
+
+    push_constant_t(VkPipelineLayout layout, VkPhysicalDevice phys_device, const bool throws = true) : layout(layout)
+    {
+        if(!supported(phys_device))
+        {
+            INFORM_ERR("push constant block of " << offset + size << " bytes exceeds maxPushConstantsSize");
+            if(throws)
+                THROW("push constant block too big");
+        }
+    }
+
+    void push(VkCommandBuffer cmd, const T& value) const
+    {
+        vkCmdPushConstants(cmd, layout, stages, offset, size, &value);
+    }
+
+private:
+    VkPipelineLayout layout;
+};
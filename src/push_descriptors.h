@@ -0,0 +1,99 @@
+#pragma once
+
+#include "vulkan_handle.h"
+#include "descriptor_allocator.h"
+#include "device_capabilities.h"
+
+/*
+    Push descriptors for small, per-draw or per-pass bindings (VK_KHR_push_descriptor).
+    Nothing is allocated from a pool; the descriptors are recorded straight into the command buffer.
+
+    data_t is a plain struct holding one VkDescriptor*Info per binding, e.g.
+
+        struct pass_bindings
+        {
+            VkDescriptorImageInfo  color;
+            VkDescriptorBufferInfo constants;
+        };
+        auto layout_desc = spirv::pipeline_layout(device, stages, layout_cache, 0);
+        vk_handle::pipeline_layout pipeline_layout(layout_desc);
+        push_descriptor_t<pass_bindings> pass(device, pipeline_layout, layout_cache, 0, {
+            push_descriptor_entry(0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, offsetof(pass_bindings, color)),
+            push_descriptor_entry(1, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, offsetof(pass_bindings, constants))
+        });
+        pass.push(cmd, bindings);
+
+    The update template is built once, so pushing is a single vkCmdPushDescriptorSetWithTemplateKHR call.
+    Construction throws if set isn't the layout's push_descriptor_set, if the cache didn't create that set layout
+    with the push descriptor flag, or if the entries hold more than maxPushDescriptors descriptors.
+*/
+inline VkDescriptorUpdateTemplateEntry push_descriptor_entry(uint32_t binding, VkDescriptorType type, size_t offset, uint32_t count = 1,
+size_t stride = 0)
+{
+    VkDescriptorUpdateTemplateEntry entry{};
+    entry.dstBinding      = binding;
+    entry.dstArrayElement = 0;
+    entry.descriptorCount = count;
+    entry.descriptorType  = type;
+    entry.offset          = offset;
+    entry.stride          = stride;
+    return entry;
+}
+
+template<typename data_t> class push_descriptor_t
+{
+public:
+    push_descriptor_t(const vk_handle::device& device, const vk_handle::pipeline_layout& pipeline_layout,
+    const descriptor_layout_cache_t& layout_cache, uint32_t set, std::vector<VkDescriptorUpdateTemplateEntry> entries,
+    VkPipelineBindPoint bind_point = VK_PIPELINE_BIND_POINT_GRAPHICS) :
+    update_template(get_template_desc(device, pipeline_layout, layout_cache, set, entries, bind_point))
+    {
+    }
+
+    void push(VkCommandBuffer cmd, const data_t& data) const
+    {
+        const auto& desc = update_template.description;
+        vkCmdPushDescriptorSetWithTemplateKHR(cmd, update_template, desc.pipeline_layout, desc.set, &data);
+    }
+
+private:
+    static vk_handle::description::descriptor_update_template_desc get_template_desc(const vk_handle::device& device,
+    const vk_handle::pipeline_layout& pipeline_layout, const descriptor_layout_cache_t& layout_cache, uint32_t set,
+    std::vector<VkDescriptorUpdateTemplateEntry> entries, VkPipelineBindPoint bind_point)
+    {
+        if(!device.description.extension_enabled(VK_KHR_PUSH_DESCRIPTOR_EXTENSION_NAME))
+            THROW("push descriptors require VK_KHR_push_descriptor");
+
+        const auto& layout_desc = pipeline_layout.description;
+        if(layout_desc.push_descriptor_set != set || set >= layout_desc.set_layouts.size())
+            THROW("set " + std::to_string(set) + " isn't the push descriptor set of the pipeline layout");
+        auto flags = layout_cache.flags(layout_desc.set_layouts[set]);
+        if(!flags.has_value() || !(flags.value() & VK_DESCRIPTOR_SET_LAYOUT_CREATE_PUSH_DESCRIPTOR_BIT_KHR))
+            THROW("set layout " + std::to_string(set) + " wasn't created with the push descriptor flag");
+
+        uint32_t count = 0;
+        for(const auto& entry : entries)
+            count += entry.descriptorCount;
+        uint32_t limit = vk_handle::device_capabilities_t::get(device.description.phys_device).push_descriptor_properties.maxPushDescriptors;
+        if(count > limit)
+            THROW("pushing " + std::to_string(count) + " descriptors, the device takes at most " + std::to_string(limit));
+
+        vk_handle::description::descriptor_update_template_desc desc{};
+        desc.parent          = device;
+        desc.entries         = entries;
+        desc.template_type   = VK_DESCRIPTOR_UPDATE_TEMPLATE_TYPE_PUSH_DESCRIPTORS_KHR;
+        desc.bind_point      = bind_point;
+        desc.pipeline_layout = pipeline_layout;
+        desc.set             = set;
+        return desc;
+    }
+
+    vk_handle::descriptor_update_template update_template;
+};
+
+//for one-off bindings that aren't worth a template
+inline void cmd_push_descriptors(VkCommandBuffer cmd, VkPipelineLayout layout, uint32_t set, const std::vector<VkWriteDescriptorSet>& writes,
+VkPipelineBindPoint bind_point = VK_PIPELINE_BIND_POINT_GRAPHICS)
+{
+    vkCmdPushDescriptorSetKHR(cmd, bind_point, layout, set, static_cast<uint32_t>(writes.size()), writes.data());
+}
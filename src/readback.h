@@ -0,0 +1,261 @@
+#pragma once
+
+#include "vulkan_handle.h"
+#include "vulkan_data_getters.h"
+
+#include <functional>
+#include <future>
+#include <memory>
+#include <vector>
+
+//bytes per texel of the uncompressed color formats read_image() is used with, 0 for anything else
+constexpr uint32_t texel_size(VkFormat format)
+{
+    switch(format)
+    {
+        case VK_FORMAT_R8_UNORM: case VK_FORMAT_R8_SRGB: case VK_FORMAT_R8_UINT:
+            return 1;
+        case VK_FORMAT_R8G8_UNORM: case VK_FORMAT_R8G8_SRGB: case VK_FORMAT_R16_SFLOAT: case VK_FORMAT_R16_UNORM:
+        case VK_FORMAT_R16_UINT: case VK_FORMAT_R5G6B5_UNORM_PACK16:
+            return 2;
+        case VK_FORMAT_R8G8B8A8_UNORM: case VK_FORMAT_R8G8B8A8_SRGB: case VK_FORMAT_B8G8R8A8_UNORM: case VK_FORMAT_B8G8R8A8_SRGB:
+        case VK_FORMAT_A2B10G10R10_UNORM_PACK32: case VK_FORMAT_A2R10G10B10_UNORM_PACK32: case VK_FORMAT_B10G11R11_UFLOAT_PACK32:
+        case VK_FORMAT_R16G16_SFLOAT: case VK_FORMAT_R32_SFLOAT: case VK_FORMAT_R32_UINT:
+            return 4;
+        case VK_FORMAT_R16G16B16A16_SFLOAT: case VK_FORMAT_R16G16B16A16_UNORM: case VK_FORMAT_R32G32_SFLOAT:
+            return 8;
+        case VK_FORMAT_R32G32B32A32_SFLOAT: case VK_FORMAT_R32G32B32A32_UINT:
+            return 16;
+        default:
+            return 0;
+    }
+}
+
+/*
+    Copies images and buffers back to the host without stalling the queue or the render loop :
+
+        readback_ring_t readback(device, allocator, 4, width * height * 4);
+        ...after the frame was submitted
+        readback.read_image(image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, extent, [](const void* pixels, VkDeviceSize size){...});
+        readback.poll();    //once per frame, runs the callbacks of the copies that finished
+
+    Every slot owns a persistently mapped GPU_TO_CPU buffer, a command buffer and a fence. The copy is submitted on the
+    graphics queue after the frame, so its fence signals once the frame and the copy are done; poll() only asks for the fence
+    status, and the mapping is never touched until then. When every slot is still in flight, read_*() drops the request
+    and returns false instead of waiting, so more slots are needed when get_dropped() keeps growing.
+
+    The data handed to a callback is only valid during the call, the slot is reused right after it.
+    Images must have been created with VK_IMAGE_USAGE_TRANSFER_SRC_BIT, buffers with VK_BUFFER_USAGE_TRANSFER_SRC_BIT.
+*/
+class readback_ring_t
+{
+public:
+    typedef std::function<void (const void* data, VkDeviceSize size)> callback_fnc;
+
+    readback_ring_t(const vk_handle::device& device, VmaAllocator allocator, uint32_t slot_count, VkDeviceSize slot_size) :
+    command_pool(vk_handle::description::cmd_pool_desc{.parent = device, .queue_fam_index = device.description.graphics_queue.fam_idx,
+    .flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT}),
+    command_buffers(vk_handle::description::cmd_buffers_desc{device, command_pool, slot_count, VK_COMMAND_BUFFER_LEVEL_PRIMARY}),
+    slot_size(slot_size), allocator(allocator), device(device)
+    {
+        slots.reserve(slot_count);
+        for(uint32_t i = 0; i < slot_count; ++i)
+            slots.emplace_back(device, allocator, slot_size);
+        queue = vk_handle::data_getters::device::queue_handle(device, device.description.graphics_queue);
+    }
+
+    //copies the top left extent of a color image, tightly packed. The image is left in layout
+    bool read_image(VkImage image, VkImageLayout layout, VkExtent2D extent, callback_fnc callback, uint32_t texel_size = 4,
+    const bool throws = true)
+    {
+        VkDeviceSize size = VkDeviceSize(extent.width) * extent.height * texel_size;
+        return submit(size, std::move(callback), [&](VkCommandBuffer cmd, VkBuffer destination)
+        {
+            VkImageMemoryBarrier barrier{};
+            barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+            barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED, barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            barrier.image = image;
+            barrier.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1};
+            barrier.srcAccessMask = VK_ACCESS_MEMORY_WRITE_BIT, barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+            barrier.oldLayout = layout, barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+            vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr,
+            1, &barrier);
+
+            VkBufferImageCopy region{};
+            region.imageSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1};
+            region.imageExtent = VkExtent3D{extent.width, extent.height, 1};
+            vkCmdCopyImageToBuffer(cmd, image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, destination, 1, &region);
+
+            //hand the image back the way we found it. Whoever renders into it next only waits on its own pass,
+            //so the copy has to be ordered before all later work here or it races the next clear
+            barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, barrier.newLayout = layout;
+            barrier.srcAccessMask = 0, barrier.dstAccessMask = 0;
+            vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, 0, nullptr, 0, nullptr,
+            1, &barrier);
+        }, throws);
+    }
+    bool read_buffer(VkBuffer buffer, VkDeviceSize offset, VkDeviceSize size, callback_fnc callback, const bool throws = true)
+    {
+        return submit(size, std::move(callback), [&](VkCommandBuffer cmd, VkBuffer destination)
+        {
+            VkMemoryBarrier barrier{};
+            barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+            barrier.srcAccessMask = VK_ACCESS_MEMORY_WRITE_BIT, barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+            vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 1, &barrier, 0, nullptr,
+            0, nullptr);
+
+            VkBufferCopy region{offset, 0, size};
+            vkCmdCopyBuffer(cmd, buffer, destination, 1, &region);
+        }, throws);
+    }
+    //same as read_buffer() but the data is copied out into a future. Empty when the request was dropped
+    std::optional<std::future<std::vector<char>>> read_buffer(VkBuffer buffer, VkDeviceSize offset, VkDeviceSize size,
+    const bool throws = true)
+    {
+        auto promise = std::make_shared<std::promise<std::vector<char>>>();
+        auto future = promise->get_future();
+        bool submitted = read_buffer(buffer, offset, size, [promise](const void* data, VkDeviceSize size)
+        {
+            const char* bytes = static_cast<const char*>(data);
+            promise->set_value(std::vector<char>(bytes, bytes + size));
+        }, throws);
+        if(!submitted)
+            return std::nullopt;
+        return std::optional<std::future<std::vector<char>>>(std::move(future));
+    }
+
+    //runs the callbacks of every finished copy, in submission order. Never waits on the GPU
+    void poll()
+    {
+        while(in_flight > 0)
+        {
+            uint32_t oldest = (next_slot + slots.size() - in_flight) % slots.size();
+            auto& slot = slots[oldest];
+            if(vkGetFenceStatus(device, slot.f_copied) != VK_SUCCESS)
+                return;
+            finish(slot);
+            in_flight--;
+        }
+    }
+    //for producers that would rather wait than drop, blocks until a read_*() would get a slot
+    void wait_for_slot()
+    {
+        poll();
+        if(in_flight < slots.size())
+            return;
+        VkFence oldest = slots[(next_slot + slots.size() - in_flight) % slots.size()].f_copied;
+        vkWaitForFences(device, 1, &oldest, VK_TRUE, UINT64_MAX);
+        poll();
+    }
+    //waits for everything in flight, e.g. before shutting down
+    void flush()
+    {
+        for(auto& slot : slots)
+        {
+            VkFence fence = slot.f_copied;
+            vkWaitForFences(device, 1, &fence, VK_TRUE, UINT64_MAX);
+        }
+        poll();
+    }
+
+    VkDeviceSize get_slot_size() const {return slot_size;}
+    uint64_t get_completed() const {return completed;}
+    uint64_t get_dropped() const {return dropped;}
+
+private:
+    typedef std::function<void (VkCommandBuffer, VkBuffer)> record_fnc;
+
+    struct slot_data
+    {
+        vk_handle::buffer    buffer;
+        vk_handle::fence  f_copied;
+        void*               mapped;
+        VkDeviceSize          size = 0;
+        callback_fnc      callback;
+
+        slot_data(const vk_handle::device& device, VmaAllocator allocator, VkDeviceSize capacity) :
+        buffer(vk_handle::description::buffer_desc
+        {
+            .parent    = device,
+            .allocator = allocator,
+            .alloc_info = VmaAllocationCreateInfo
+            {
+                //mapped once for the lifetime of the buffer, reading it never calls into the driver
+                .flags = VMA_ALLOCATION_CREATE_HOST_ACCESS_RANDOM_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT,
+                .usage = VMA_MEMORY_USAGE_AUTO_PREFER_HOST,
+                .pool = VK_NULL_HANDLE
+            },
+            .size  = capacity,
+            .usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+            .queue_fam_indices = {device.description.graphics_queue.fam_idx}
+        }),
+        f_copied(vk_handle::description::fence_desc{device, VK_FENCE_CREATE_SIGNALED_BIT})
+        {
+            VmaAllocationInfo info{};
+            vmaGetAllocationInfo(allocator, buffer.description.allocation_object, &info);
+            mapped = info.pMappedData;
+        }
+    };
+
+    bool submit(VkDeviceSize size, callback_fnc callback, record_fnc record, const bool throws)
+    {
+        EXIT_IF(size > slot_size, "READBACK DOES NOT FIT A SLOT", DO_NOTHING);
+        poll();
+        if(in_flight == slots.size())
+        {
+            dropped++;
+            return false;
+        }
+
+        auto& slot = slots[next_slot];
+        const auto& cmd_buffer = command_buffers.handle[next_slot];
+        VkFence slot_fence = slot.f_copied;
+        vkResetFences(device, 1, &slot_fence);
+
+        VkCommandBufferBeginInfo begin_info{};
+        begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+        EXIT_IF(vkBeginCommandBuffer(cmd_buffer, &begin_info), "FAILED TO BEGIN READBACK CMD BUFFER", DO_NOTHING);
+        record(cmd_buffer, slot.buffer);
+        //make the copy visible to the host once the fence signals
+        VkMemoryBarrier barrier{};
+        barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT, barrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+        vkCmdPipelineBarrier(cmd_buffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+        EXIT_IF(vkEndCommandBuffer(cmd_buffer), "FAILED TO END READBACK CMD BUFFER", DO_NOTHING);
+
+        VkSubmitInfo submit_info{};
+        submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        submit_info.commandBufferCount = 1, submit_info.pCommandBuffers = &cmd_buffer;
+        EXIT_IF(vkQueueSubmit(queue, 1, &submit_info, slot_fence), "FAILED TO SUBMIT READBACK CMD BUFFER", DO_NOTHING);
+
+        slot.size = size;
+        slot.callback = std::move(callback);
+        next_slot = (next_slot + 1) % slots.size();
+        in_flight++;
+        return true;
+    }
+    void finish(slot_data& slot)
+    {
+        //no-op on coherent memory
+        vmaInvalidateAllocation(allocator, slot.buffer.description.allocation_object, 0, slot.size);
+        if(slot.callback)
+            slot.callback(slot.mapped, slot.size);
+        slot.callback = nullptr;
+        completed++;
+    }
+
+    vk_handle::cmd_pool         command_pool;
+    vk_handle::cmd_buffers   command_buffers;
+    std::vector<slot_data>             slots;
+
+    VkDeviceSize              slot_size;
+    VmaAllocator              allocator;
+    VkDevice                     device;
+    VkQueue                       queue;
+
+    uint32_t                 next_slot = 0;
+    uint32_t                 in_flight = 0;
+    uint64_t                 completed = 0;
+    uint64_t                   dropped = 0;
+};
@@ -0,0 +1,189 @@
+#pragma once
+
+#include "vulkan_handle.h"
+#include "dynamic_state.h"
+
+#include <vector>
+#include <functional>
+#include <optional>
+
+/*
+    Draws with VK_EXT_shader_object instead of a pipeline. The shaders are created straight from the module byte code
+    and everything a pipeline would bake in is set on the command buffer by bind() :
+
+        shader_object_pipeline_t objects(device, layout.description, {vertex_shader, fragment_shader}, pipeline_desc);
+        ...between vkCmdBeginRenderingKHR and vkCmdEndRenderingKHR
+        objects.draw_state.cull_mode = VK_CULL_MODE_BACK_BIT;
+        objects.bind(cmd, viewport, scissor);
+        vkCmdDrawIndexed(...);
+
+    Nothing is compiled ahead of the first draw, so a permutation costs one vkCreateShadersEXT and a hot reload is
+    replace(). Shader objects only work with dynamic rendering, the device enables the extension only together with it.
+    The state comes from the graphics_pipeline_desc this replaces; its renderpass, layout and dynamic states are ignored.
+    Its stages' specialization info is kept, so the constants it points to must live as long as this.
+*/
+class shader_object_pipeline_t
+{
+public:
+    //what make_dynamic() would leave to the command buffer, here it is all of it
+    draw_state_t draw_state;
+
+    shader_object_pipeline_t(const vk_handle::device& device, const vk_handle::description::pipeline_layout_desc& layout,
+    const std::vector<std::reference_wrapper<vk_handle::shader_module>> shaders, const vk_handle::description::graphics_pipeline_desc& state) :
+    draw_state(draw_state_t::from(state)), layout(layout)
+    {
+        for(const auto& shader : shaders)
+        {
+            stages.push_back(shader.get().description.stage);
+            next_stages |= shader.get().description.stage;
+            //same constants the pipeline would have been specialized with
+            auto& specialization = specializations.emplace_back();
+            for(const auto& stage : state.shader_stages_info)
+                if(stage.stage == shader.get().description.stage)
+                    specialization = stage.specialization_info;
+        }
+        objects.reserve(shaders.size());
+        for(const auto& shader : shaders)
+            objects.emplace_back(get_object_desc(shader.get().description, specializations[objects.size()]));
+        handles.assign(objects.begin(), objects.end());
+
+        const auto& features = device.description.enabled_features;
+        if(features.tessellationShader)
+            unused_stages.insert(unused_stages.end(), {VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT, VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT});
+        if(features.geometryShader)
+            unused_stages.push_back(VK_SHADER_STAGE_GEOMETRY_BIT);
+        unused_handles.assign(unused_stages.size(), VK_NULL_HANDLE);
+        depth_bounds = features.depthBounds, depth_clamp = features.depthClamp, logic_op = features.logicOp;
+
+        const auto& vi = state.vertex_input_info;
+        auto bindings = vi.static_binding_descriptions.empty() ? std::span<const VkVertexInputBindingDescription>(vi.binding_descriptions)
+        : vi.static_binding_descriptions;
+        auto attribs  = vi.static_attrib_descriptions.empty() ? std::span<const VkVertexInputAttributeDescription>(vi.attrib_descriptions)
+        : vi.static_attrib_descriptions;
+        for(const auto& b : bindings)
+            vertex_bindings.push_back(VkVertexInputBindingDescription2EXT{VK_STRUCTURE_TYPE_VERTEX_INPUT_BINDING_DESCRIPTION_2_EXT, nullptr,
+            b.binding, b.stride, b.inputRate, 1});
+        for(const auto& a : attribs)
+            vertex_attribs.push_back(VkVertexInputAttributeDescription2EXT{VK_STRUCTURE_TYPE_VERTEX_INPUT_ATTRIBUTE_DESCRIPTION_2_EXT, nullptr,
+            a.location, a.binding, a.format, a.offset});
+
+        samples = state.multisample_info.rasterization_samples;
+        line_width = state.rasterization_info.line_width > 0.0f ? state.rasterization_info.line_width : 1.0f;
+        depth_bias_factors = {state.rasterization_info.depth_bias_constant_factor, state.rasterization_info.depth_bias_clamp,
+        state.rasterization_info.depth_bias_slope_factor};
+
+        const auto& cb = state.color_blend_info;
+        logic_op_enabled = cb.logic_op_enabled, logic_op_value = cb.logic_op;
+        blend_constants = cb.blend_constants;
+        for(const auto& attachment : cb.attachment_states)
+        {
+            blend_enables.push_back(attachment.blendEnable);
+            write_masks.push_back(attachment.colorWriteMask);
+            blend_equations.push_back(VkColorBlendEquationEXT{attachment.srcColorBlendFactor, attachment.dstColorBlendFactor,
+            attachment.colorBlendOp, attachment.srcAlphaBlendFactor, attachment.dstAlphaBlendFactor, attachment.alphaBlendOp});
+        }
+    }
+
+    //swaps the shader of the module's stage, e.g. after the file changed. The old one must not be in flight anymore
+    void replace(const vk_handle::shader_module& shader)
+    {
+        for(size_t i = 0; i < stages.size(); ++i)
+            if(stages[i] == shader.description.stage)
+            {
+                objects[i] = vk_handle::shader_object(get_object_desc(shader.description, specializations[i]));
+                handles[i] = objects[i];
+            }
+    }
+
+    //binds the shaders and sets every piece of state the draw needs
+    void bind(VkCommandBuffer cmd, const VkViewport& viewport, const VkRect2D& scissor) const
+    {
+        vkCmdBindShadersEXT(cmd, static_cast<uint32_t>(stages.size()), stages.data(), handles.data());
+        if(!unused_stages.empty())
+            vkCmdBindShadersEXT(cmd, static_cast<uint32_t>(unused_stages.size()), unused_stages.data(), unused_handles.data());
+
+        vkCmdSetViewportWithCountEXT(cmd, 1, &viewport);
+        vkCmdSetScissorWithCountEXT(cmd, 1, &scissor);
+        vkCmdSetVertexInputEXT(cmd, static_cast<uint32_t>(vertex_bindings.size()), vertex_bindings.data(),
+        static_cast<uint32_t>(vertex_attribs.size()), vertex_attribs.data());
+
+        vkCmdSetPrimitiveTopologyEXT(cmd, draw_state.topology);
+        vkCmdSetPrimitiveRestartEnableEXT(cmd, draw_state.primitive_restart);
+        vkCmdSetRasterizerDiscardEnableEXT(cmd, draw_state.rasterizer_discard);
+        vkCmdSetPolygonModeEXT(cmd, draw_state.polygon_mode);
+        vkCmdSetCullModeEXT(cmd, draw_state.cull_mode);
+        vkCmdSetFrontFaceEXT(cmd, draw_state.front_face);
+        if(topology_class(draw_state.topology) == VK_PRIMITIVE_TOPOLOGY_LINE_LIST || draw_state.polygon_mode == VK_POLYGON_MODE_LINE)
+            vkCmdSetLineWidth(cmd, line_width);
+
+        VkSampleMask sample_mask = ~0u;
+        vkCmdSetRasterizationSamplesEXT(cmd, samples);
+        vkCmdSetSampleMaskEXT(cmd, samples, &sample_mask);
+        vkCmdSetAlphaToCoverageEnableEXT(cmd, VK_FALSE);
+
+        vkCmdSetDepthTestEnableEXT(cmd, draw_state.depth_test);
+        vkCmdSetDepthWriteEnableEXT(cmd, draw_state.depth_write);
+        vkCmdSetDepthCompareOpEXT(cmd, draw_state.depth_compare_op);
+        vkCmdSetDepthBiasEnableEXT(cmd, draw_state.depth_bias);
+        if(draw_state.depth_bias)
+            vkCmdSetDepthBias(cmd, depth_bias_factors[0], depth_bias_factors[1], depth_bias_factors[2]);
+        vkCmdSetStencilTestEnableEXT(cmd, VK_FALSE);
+        if(depth_bounds)
+            vkCmdSetDepthBoundsTestEnableEXT(cmd, VK_FALSE);
+        if(depth_clamp)
+            vkCmdSetDepthClampEnableEXT(cmd, draw_state.depth_clamp);
+
+        if(logic_op)
+            vkCmdSetLogicOpEnableEXT(cmd, logic_op_enabled);
+        if(logic_op && logic_op_enabled)
+            vkCmdSetLogicOpEXT(cmd, logic_op_value);
+        uint32_t attachment_count = static_cast<uint32_t>(blend_enables.size());
+        if(attachment_count > 0)
+        {
+            vkCmdSetColorBlendEnableEXT(cmd, 0, attachment_count, blend_enables.data());
+            vkCmdSetColorWriteMaskEXT(cmd, 0, attachment_count, write_masks.data());
+            vkCmdSetColorBlendEquationEXT(cmd, 0, attachment_count, blend_equations.data());
+        }
+        if(blend_constants.has_value())
+            vkCmdSetBlendConstants(cmd, blend_constants.value().data());
+    }
+
+private:
+    vk_handle::description::shader_object_desc get_object_desc(const vk_handle::description::shader_module_desc& module,
+    const std::optional<VkSpecializationInfo>& specialization) const
+    {
+        //a vertex shader can be followed by whatever else is bound with it
+        VkShaderStageFlags next = 0;
+        if(module.stage == VK_SHADER_STAGE_VERTEX_BIT)
+            next = next_stages & ~VK_SHADER_STAGE_VERTEX_BIT;
+        vk_handle::description::shader_object_desc desc(module, layout, next);
+        desc.specialization_info = specialization;
+        return desc;
+    }
+
+    vk_handle::description::pipeline_layout_desc layout;
+
+    std::vector<vk_handle::shader_object>   objects;
+    std::vector<VkShaderEXT>                 handles;   //of objects, what bind() hands vulkan
+    std::vector<VkShaderStageFlagBits>       stages;
+    //point into whatever the state's description pointed into, which has to outlive replace() too
+    std::vector<std::optional<VkSpecializationInfo>> specializations;
+    VkShaderStageFlags                  next_stages = 0;
+    std::vector<VkShaderStageFlagBits> unused_stages;
+    std::vector<VkShaderEXT>          unused_handles;   //all VK_NULL_HANDLE, unbinds unused_stages
+
+    std::vector<VkVertexInputBindingDescription2EXT>   vertex_bindings;
+    std::vector<VkVertexInputAttributeDescription2EXT>  vertex_attribs;
+
+    VkSampleCountFlagBits                 samples;
+    float                              line_width;
+    std::array<float, 3>       depth_bias_factors;  //constant, clamp, slope
+    VkBool32             depth_bounds, depth_clamp, logic_op;
+
+    VkBool32                     logic_op_enabled;
+    VkLogicOp                      logic_op_value;
+    std::optional<std::array<float, 4>> blend_constants;
+    std::vector<VkBool32>             blend_enables;
+    std::vector<VkColorComponentFlags>  write_masks;
+    std::vector<VkColorBlendEquationEXT> blend_equations;
+};
@@ -0,0 +1,205 @@
+#pragma once
+
+#include "vulkan_handle.h"
+#include "spirv_reflect.h"
+#include "hash.h"
+
+#include <unordered_map>
+#include <algorithm>
+#include <cstring>
+
+/*
+    A set of specialization constant values that owns its storage :
+
+        specialization_constants_t constants;
+        constants.set(0, 4u);                                 //by constant_id
+        constants.set(frag_reflection, "USE_SHADOWS", true);  //by name, through reflection
+
+    One set is shared by every stage of a pipeline. Vulkan ignores map entries a stage doesn't use.
+    Entries are kept sorted by id, so equal sets hash equally no matter the order they were set in.
+*/
+class specialization_constants_t
+{
+public:
+    //bools are stored as VkBool32, like the spec wants
+    template<typename T> specialization_constants_t& set(uint32_t id, T value)
+    {
+        static_assert(std::is_arithmetic_v<T>, "specialization constants are scalars");
+        if constexpr (std::is_same_v<T, bool>)
+        {
+            VkBool32 flag = value ? VK_TRUE : VK_FALSE;
+            return set_bytes(id, &flag, sizeof(VkBool32));
+        }
+        else
+            return set_bytes(id, &value, sizeof(T));
+    }
+    template<typename T> specialization_constants_t& set(const spirv::module_reflection& module, const std::string& name, T value)
+    {
+        for(const auto& constant : module.spec_constants)
+        {
+            if(constant.name != name)
+                continue;
+            uint32_t size = std::is_same_v<T, bool> ? sizeof(VkBool32) : sizeof(T);
+            if(size != constant.size)
+                INFORM_ERR("WARNING : specialization constant " << name << " is " << constant.size << " bytes, got " << size);
+            return set(constant.id, value);
+        }
+        INFORM_ERR("WARNING : no specialization constant named " << name);
+        return *this;
+    }
+
+    bool empty() const {return entries.empty();}
+    //points into this object, keep it alive (and unmodified) until the pipeline is created
+    VkSpecializationInfo get_info() const
+    {
+        VkSpecializationInfo info{};
+        info.mapEntryCount = static_cast<uint32_t>(entries.size());
+        info.pMapEntries   = entries.data();
+        info.dataSize      = data.size();
+        info.pData         = data.data();
+        return info;
+    }
+    uint64_t hash(uint64_t seed = HASH_SEED) const
+    {
+        uint64_t hash = seed;
+        for(const auto& entry : entries)
+        {
+            hash = hash_value(entry.constantID, hash);
+            hash = hash_value(entry.size, hash);
+            hash = hash_bytes(data.data() + entry.offset, entry.size, hash);
+        }
+        return hash;
+    }
+    bool operator ==(const specialization_constants_t& rhs) const
+    {
+        if(entries.size() != rhs.entries.size())
+            return false;
+        for(size_t i = 0; i < entries.size(); ++i)
+        {
+            const auto& a = entries[i];
+            const auto& b = rhs.entries[i];
+            if(a.constantID != b.constantID || a.size != b.size || std::memcmp(&data[a.offset], &rhs.data[b.offset], a.size) != 0)
+                return false;
+        }
+        return true;
+    }
+
+private:
+    specialization_constants_t& set_bytes(uint32_t id, const void* value, size_t size)
+    {
+        auto itr = std::lower_bound(entries.begin(), entries.end(), id, [](const VkSpecializationMapEntry& e, uint32_t id)
+        {return e.constantID < id;});
+        if(itr != entries.end() && itr->constantID == id && itr->size == size)
+        {
+            std::memcpy(&data[itr->offset], value, size);
+            return *this;
+        }
+        if(itr != entries.end() && itr->constantID == id)   //size changed, drop the old bytes where they are
+            itr = entries.erase(itr);
+        uint32_t offset = static_cast<uint32_t>(data.size());
+        data.resize(data.size() + size);
+        std::memcpy(&data[offset], value, size);
+        entries.insert(itr, VkSpecializationMapEntry{id, offset, size});
+        return *this;
+    }
+
+    std::vector<VkSpecializationMapEntry> entries;
+    std::vector<uint8_t>                     data;
+};
+
+//points every stage of desc at constants, or clears the stages' specialization info for an empty set
+inline void specialize(vk_handle::description::graphics_pipeline_desc& desc, const specialization_constants_t& constants)
+{
+    for(auto& stage : desc.shader_stages_info)
+    {
+        if(constants.empty())
+            stage.specialization_info.reset();
+        else
+            stage.specialization_info = constants.get_info();
+    }
+}
+
+/*
+    Pipeline variants of a base description, one per distinct set of specialization constants.
+    Use it for branch-free or unrolled versions of hot shaders :
+
+        uint32_t lit = permutations.add_base(lit_desc);
+        ...
+        VkPipeline pipeline = permutations.get(lit, specialization_constants_t{}.set(0, light_count));
+
+    Variants are created on first use and live as long as the cache.
+*/
+class pipeline_permutations_t
+{
+public:
+    pipeline_permutations_t() = default;
+
+    //the description must be complete except for specialization info, which is overwritten per variant
+    uint32_t add_base(vk_handle::description::graphics_pipeline_desc desc)
+    {
+        bases.push_back(std::move(desc));
+        return static_cast<uint32_t>(bases.size() - 1);
+    }
+    //returns VK_NULL_HANDLE on failure, or throws if throws is set
+    VkPipeline get(uint32_t base, const specialization_constants_t& constants, const bool throws = true)
+    {
+        uint64_t key = constants.hash(hash_value(base));
+        auto itr = variants.find(key);
+        if(itr != variants.end())
+        {
+            if(itr->second.base == base && itr->second.constants == constants)
+                return itr->second.pipeline.handle[0];
+            INFORM_ERR("WARNING : pipeline permutation hash collision, variant is not cached");
+            return create_uncached(base, constants, throws);
+        }
+        try
+        {
+            auto result = variants.try_emplace(key, base, constants, bases[base]);
+            return result.first->second.pipeline.handle[0];
+        }
+        catch(const std::exception&)
+        {
+            if(throws)
+                throw;
+            return VK_NULL_HANDLE;
+        }
+    }
+    size_t size() const {return variants.size();}
+
+private:
+    struct variant
+    {
+        uint32_t                                 base;
+        specialization_constants_t          constants;
+        vk_handle::graphics_pipeline         pipeline;
+
+        variant(uint32_t base, const specialization_constants_t& constants, const vk_handle::description::graphics_pipeline_desc& desc) :
+        base(base), constants(constants), pipeline({get_desc(desc, this->constants)})
+        {
+        }
+        static vk_handle::description::graphics_pipeline_desc get_desc(vk_handle::description::graphics_pipeline_desc desc,
+        const specialization_constants_t& constants)
+        {
+            specialize(desc, constants);
+            return desc;
+        }
+    };
+    VkPipeline create_uncached(uint32_t base, const specialization_constants_t& constants, const bool throws)
+    {
+        try
+        {
+            uncached.emplace_back(base, constants, bases[base]);
+            return uncached.back().pipeline.handle[0];
+        }
+        catch(const std::exception&)
+        {
+            if(throws)
+                throw;
+            return VK_NULL_HANDLE;
+        }
+    }
+
+    std::vector<vk_handle::description::graphics_pipeline_desc> bases;
+    std::unordered_map<uint64_t, variant>                    variants;
+    std::vector<variant>                                     uncached;
+};
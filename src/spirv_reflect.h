@@ -0,0 +1,647 @@
+#pragma once
+
+#include "vulkan_handle_description.h"
+#include "descriptor_allocator.h"
+#include "hash.h"
+#include "debug.h"
+
+#include <unordered_map>
+#include <mutex>
+#include <map>
+#include <algorithm>
+
+/*
+    Minimal SPIR-V reflection. Walks the instruction stream once and pulls out what we need to build
+    pipeline state without writing it by hand : vertex inputs, descriptor bindings, push constant blocks
+    and specialization constants.
+
+    Results are cached by module hash (see reflect_cached), so creating a pipeline never parses a module twice.
+    The opcode and enum values below are from the SPIR-V 1.6 spec; we only care about a handful of them.
+*/
+namespace spirv
+{
+    constexpr uint32_t MAGIC_NUMBER = 0x07230203;
+    constexpr size_t   HEADER_WORDS = 5;
+
+    namespace op
+    {
+        enum : uint32_t
+        {
+            NAME                = 5,
+            ENTRY_POINT         = 15,
+            TYPE_BOOL           = 20,
+            TYPE_INT            = 21,
+            TYPE_FLOAT          = 22,
+            TYPE_VECTOR         = 23,
+            TYPE_MATRIX         = 24,
+            TYPE_IMAGE          = 25,
+            TYPE_SAMPLER        = 26,
+            TYPE_SAMPLED_IMAGE  = 27,
+            TYPE_ARRAY          = 28,
+            TYPE_RUNTIME_ARRAY  = 29,
+            TYPE_STRUCT         = 30,
+            TYPE_POINTER        = 32,
+            CONSTANT            = 43,
+            SPEC_CONSTANT_TRUE  = 48,
+            SPEC_CONSTANT_FALSE = 49,
+            SPEC_CONSTANT       = 50,
+            VARIABLE            = 59,
+            DECORATE            = 71,
+            MEMBER_DECORATE     = 72,
+            TYPE_ACCELERATION_STRUCTURE = 5341,
+        };
+    }
+    namespace decoration
+    {
+        enum : uint32_t
+        {
+            SPEC_ID        = 1,
+            BLOCK          = 2,
+            BUFFER_BLOCK   = 3,
+            ARRAY_STRIDE   = 6,
+            MATRIX_STRIDE  = 7,
+            BUILT_IN       = 11,
+            LOCATION       = 30,
+            BINDING        = 33,
+            DESCRIPTOR_SET = 34,
+            OFFSET         = 35,
+        };
+    }
+    namespace storage_class
+    {
+        enum : uint32_t
+        {
+            UNIFORM_CONSTANT = 0,
+            INPUT            = 1,
+            UNIFORM          = 2,
+            PUSH_CONSTANT    = 9,
+            STORAGE_BUFFER   = 12,
+        };
+    }
+
+    struct vertex_input
+    {
+        uint32_t   location;
+        VkFormat     format;
+        uint32_t       size;
+        std::string    name;
+    };
+    struct descriptor_binding
+    {
+        uint32_t set, binding;
+        VkDescriptorType  type;
+        uint32_t         count;   //0 for runtime arrays, the caller decides how big those are (see runtime_array_counts)
+        std::string       name;
+    };
+    struct push_constant_block
+    {
+        uint32_t offset, size;
+    };
+    struct specialization_constant
+    {
+        uint32_t              id;
+        uint32_t            size;
+        uint32_t   default_value;   //first word only
+        std::string         name;
+    };
+    struct module_reflection
+    {
+        VkShaderStageFlagBits                          stage;
+        std::string                              entry_point;
+        std::vector<vertex_input>                     inputs;   //sorted by location, built-ins excluded
+        std::vector<descriptor_binding>             bindings;
+        std::optional<push_constant_block>    push_constants;
+        std::vector<specialization_constant>  spec_constants;
+    };
+
+    namespace detail
+    {
+        struct type_info
+        {
+            uint32_t opcode = 0;
+            uint32_t width = 0, signedness = 0;            //int, float
+            uint32_t component_type = 0, count = 0;        //vector (count = components), matrix (count = columns), array (count = length id)
+            uint32_t image_dim = 0, image_sampled = 0;     //image
+            uint32_t storage = 0;                          //pointer (component_type = pointee)
+            std::vector<uint32_t> members;                 //struct
+        };
+        struct decorations
+        {
+            std::optional<uint32_t> location, binding, set, spec_id, array_stride, offset, matrix_stride;
+            bool built_in = false, block = false, buffer_block = false;
+        };
+        struct variable
+        {
+            uint32_t id, type, storage;
+        };
+
+        class parser
+        {
+        public:
+            parser(const uint32_t* words, size_t word_count) : words(words), word_count(word_count) {}
+
+            module_reflection parse()
+            {
+                if(word_count < HEADER_WORDS || words[0] != MAGIC_NUMBER)
+                    THROW("invalid SPIR-V module");
+                size_t i = HEADER_WORDS;
+                while(i < word_count)
+                {
+                    uint32_t count  = words[i] >> 16;
+                    uint32_t opcode = words[i] & 0xFFFF;
+                    if(count == 0 || i + count > word_count)
+                        THROW("malformed SPIR-V instruction");
+                    instruction(opcode, &words[i + 1], count - 1);
+                    i += count;
+                }
+                return build();
+            }
+
+        private:
+            const uint32_t* words;
+            size_t     word_count;
+
+            uint32_t execution_model = 0;
+            bool found_entry_point = false;
+            std::string entry_point;
+
+            std::unordered_map<uint32_t, std::string>    names;
+            std::unordered_map<uint32_t, type_info>      types;
+            std::unordered_map<uint32_t, uint32_t>   constants;
+            std::unordered_map<uint32_t, decorations>    decos;
+            std::map<std::pair<uint32_t, uint32_t>, decorations> member_decos;
+            std::vector<variable>                    variables;
+            std::vector<uint32_t>               spec_constant_ids;
+            std::unordered_map<uint32_t, std::pair<uint32_t, uint32_t>> spec_constant_values; //id -> (type, default)
+
+            static std::string read_string(const uint32_t* operands, uint32_t operand_count)
+            {
+                const char* chars = reinterpret_cast<const char*>(operands);
+                size_t max_len = operand_count * sizeof(uint32_t);
+                size_t len = 0;
+                while(len < max_len && chars[len] != '\0')
+                    len++;
+                return std::string(chars, len);
+            }
+            static void decorate(decorations& d, uint32_t decoration, const uint32_t* literals, uint32_t literal_count)
+            {
+                auto literal = [&]() -> std::optional<uint32_t> {
+                    if(literal_count == 0) return std::nullopt;
+                    return literals[0];
+                };
+                switch(decoration)
+                {
+                    case decoration::SPEC_ID       : d.spec_id       = literal(); break;
+                    case decoration::BLOCK         : d.block         =    true; break;
+                    case decoration::BUFFER_BLOCK  : d.buffer_block  =    true; break;
+                    case decoration::ARRAY_STRIDE  : d.array_stride  = literal(); break;
+                    case decoration::MATRIX_STRIDE : d.matrix_stride = literal(); break;
+                    case decoration::BUILT_IN      : d.built_in      =    true; break;
+                    case decoration::LOCATION      : d.location      = literal(); break;
+                    case decoration::BINDING       : d.binding       = literal(); break;
+                    case decoration::DESCRIPTOR_SET: d.set           = literal(); break;
+                    case decoration::OFFSET        : d.offset        = literal(); break;
+                    default: break;
+                }
+            }
+            void instruction(uint32_t opcode, const uint32_t* o, uint32_t n)
+            {
+                switch(opcode)
+                {
+                case op::NAME:
+                    if(n >= 2) names[o[0]] = read_string(o + 1, n - 1);
+                    break;
+                case op::ENTRY_POINT:
+                    //we only reflect the first entry point
+                    if(n >= 3 && !found_entry_point)
+                    {
+                        execution_model = o[0];
+                        entry_point = read_string(o + 2, n - 2);
+                        found_entry_point = true;
+                    }
+                    break;
+                case op::TYPE_BOOL:
+                case op::TYPE_SAMPLER:
+                case op::TYPE_ACCELERATION_STRUCTURE:
+                    types[o[0]].opcode = opcode;
+                    break;
+                case op::TYPE_INT:
+                    types[o[0]] = type_info{.opcode = opcode, .width = o[1], .signedness = o[2]};
+                    break;
+                case op::TYPE_FLOAT:
+                    types[o[0]] = type_info{.opcode = opcode, .width = o[1], .signedness = 1};
+                    break;
+                case op::TYPE_VECTOR:
+                case op::TYPE_MATRIX:
+                case op::TYPE_ARRAY:
+                    types[o[0]] = type_info{.opcode = opcode, .component_type = o[1], .count = o[2]};
+                    break;
+                case op::TYPE_RUNTIME_ARRAY:
+                case op::TYPE_SAMPLED_IMAGE:
+                    types[o[0]] = type_info{.opcode = opcode, .component_type = o[1]};
+                    break;
+                case op::TYPE_IMAGE:
+                    types[o[0]] = type_info{.opcode = opcode, .component_type = o[1], .image_dim = o[2], .image_sampled = o[6]};
+                    break;
+                case op::TYPE_STRUCT:
+                    types[o[0]] = type_info{.opcode = opcode, .members = std::vector<uint32_t>(o + 1, o + n)};
+                    break;
+                case op::TYPE_POINTER:
+                    types[o[0]] = type_info{.opcode = opcode, .component_type = o[2], .storage = o[1]};
+                    break;
+                case op::CONSTANT:
+                    if(n >= 3) constants[o[1]] = o[2];
+                    break;
+                case op::SPEC_CONSTANT_TRUE:
+                case op::SPEC_CONSTANT_FALSE:
+                    spec_constant_ids.push_back(o[1]);
+                    spec_constant_values[o[1]] = {o[0], opcode == op::SPEC_CONSTANT_TRUE ? 1u : 0u};
+                    constants[o[1]] = opcode == op::SPEC_CONSTANT_TRUE ? 1u : 0u;
+                    break;
+                case op::SPEC_CONSTANT:
+                    spec_constant_ids.push_back(o[1]);
+                    spec_constant_values[o[1]] = {o[0], n >= 3 ? o[2] : 0u};
+                    constants[o[1]] = n >= 3 ? o[2] : 0u;   //array sizes can be spec constants, use the default
+                    break;
+                case op::VARIABLE:
+                    variables.push_back(variable{o[1], o[0], o[2]});
+                    break;
+                case op::DECORATE:
+                    if(n >= 2) decorate(decos[o[0]], o[1], o + 2, n - 2);
+                    break;
+                case op::MEMBER_DECORATE:
+                    if(n >= 3) decorate(member_decos[{o[0], o[1]}], o[2], o + 3, n - 3);
+                    break;
+                default:
+                    break;
+                }
+            }
+
+            const type_info& type(uint32_t id) const
+            {
+                auto itr = types.find(id);
+                if(itr == types.end())
+                    THROW("SPIR-V references an unknown type");
+                return itr->second;
+            }
+            const decorations* deco(uint32_t id) const
+            {
+                auto itr = decos.find(id);
+                return itr == decos.end() ? nullptr : &itr->second;
+            }
+            const decorations* member_deco(uint32_t id, uint32_t member) const
+            {
+                auto itr = member_decos.find({id, member});
+                return itr == member_decos.end() ? nullptr : &itr->second;
+            }
+            uint32_t constant(uint32_t id) const
+            {
+                auto itr = constants.find(id);
+                return itr == constants.end() ? 1 : itr->second;
+            }
+
+            //byte size as laid out in a buffer block
+            uint32_t size_of(uint32_t id, uint32_t matrix_stride = 0) const
+            {
+                const auto& t = type(id);
+                switch(t.opcode)
+                {
+                case op::TYPE_BOOL   : return 4;
+                case op::TYPE_INT    :
+                case op::TYPE_FLOAT  : return t.width / 8;
+                case op::TYPE_VECTOR : return t.count * size_of(t.component_type);
+                case op::TYPE_MATRIX : return t.count * (matrix_stride != 0 ? matrix_stride : size_of(t.component_type));
+                case op::TYPE_ARRAY  :
+                {
+                    auto d = deco(id);
+                    uint32_t stride = (d && d->array_stride) ? d->array_stride.value() : size_of(t.component_type);
+                    return constant(t.count) * stride;
+                }
+                case op::TYPE_STRUCT :
+                {
+                    uint32_t size = 0, running_offset = 0;
+                    for(uint32_t m = 0; m < t.members.size(); ++m)
+                    {
+                        auto d = member_deco(id, m);
+                        uint32_t offset = (d && d->offset) ? d->offset.value() : running_offset;
+                        uint32_t stride = (d && d->matrix_stride) ? d->matrix_stride.value() : 0;
+                        running_offset  = offset + size_of(t.members[m], stride);
+                        size = std::max(size, running_offset);
+                    }
+                    return size;
+                }
+                default: return 0;
+                }
+            }
+            static VkFormat format_of(const type_info& scalar, uint32_t components)
+            {
+                if(components < 1 || components > 4)
+                    return VK_FORMAT_UNDEFINED;
+                static constexpr VkFormat f16[] = {VK_FORMAT_R16_SFLOAT, VK_FORMAT_R16G16_SFLOAT, VK_FORMAT_R16G16B16_SFLOAT, VK_FORMAT_R16G16B16A16_SFLOAT};
+                static constexpr VkFormat f32[] = {VK_FORMAT_R32_SFLOAT, VK_FORMAT_R32G32_SFLOAT, VK_FORMAT_R32G32B32_SFLOAT, VK_FORMAT_R32G32B32A32_SFLOAT};
+                static constexpr VkFormat f64[] = {VK_FORMAT_R64_SFLOAT, VK_FORMAT_R64G64_SFLOAT, VK_FORMAT_R64G64B64_SFLOAT, VK_FORMAT_R64G64B64A64_SFLOAT};
+                static constexpr VkFormat i32[] = {VK_FORMAT_R32_SINT, VK_FORMAT_R32G32_SINT, VK_FORMAT_R32G32B32_SINT, VK_FORMAT_R32G32B32A32_SINT};
+                static constexpr VkFormat u32[] = {VK_FORMAT_R32_UINT, VK_FORMAT_R32G32_UINT, VK_FORMAT_R32G32B32_UINT, VK_FORMAT_R32G32B32A32_UINT};
+                if(scalar.opcode == op::TYPE_FLOAT)
+                {
+                    if(scalar.width == 16) return f16[components - 1];
+                    if(scalar.width == 32) return f32[components - 1];
+                    if(scalar.width == 64) return f64[components - 1];
+                }
+                if(scalar.opcode == op::TYPE_INT && scalar.width == 32)
+                    return scalar.signedness ? i32[components - 1] : u32[components - 1];
+                return VK_FORMAT_UNDEFINED;
+            }
+            VkShaderStageFlagBits stage() const
+            {
+                switch(execution_model)
+                {
+                case 0 : return VK_SHADER_STAGE_VERTEX_BIT;
+                case 1 : return VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT;
+                case 2 : return VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT;
+                case 3 : return VK_SHADER_STAGE_GEOMETRY_BIT;
+                case 4 : return VK_SHADER_STAGE_FRAGMENT_BIT;
+                case 5 : return VK_SHADER_STAGE_COMPUTE_BIT;
+                default: return VK_SHADER_STAGE_ALL;
+                }
+            }
+            std::string name_of(uint32_t id) const
+            {
+                auto itr = names.find(id);
+                return itr == names.end() ? std::string() : itr->second;
+            }
+
+            std::optional<VkDescriptorType> descriptor_type(uint32_t type_id, uint32_t storage, uint32_t& count) const
+            {
+                count = 1;
+                const type_info* t = &type(type_id);
+                uint32_t id = type_id;
+                //unwrap (one level of) arrays
+                if(t->opcode == op::TYPE_ARRAY)
+                {
+                    count = constant(t->count);
+                    id = t->component_type, t = &type(id);
+                }
+                else if(t->opcode == op::TYPE_RUNTIME_ARRAY)
+                {
+                    count = 0;
+                    id = t->component_type, t = &type(id);
+                }
+                switch(t->opcode)
+                {
+                case op::TYPE_SAMPLER       : return VK_DESCRIPTOR_TYPE_SAMPLER;
+                case op::TYPE_SAMPLED_IMAGE : return VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+                case op::TYPE_ACCELERATION_STRUCTURE : return VK_DESCRIPTOR_TYPE_ACCELERATION_STRUCTURE_KHR;
+                case op::TYPE_IMAGE :
+                {
+                    constexpr uint32_t DIM_BUFFER = 5, DIM_SUBPASS_DATA = 6;
+                    if(t->image_dim == DIM_SUBPASS_DATA)
+                        return VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT;
+                    if(t->image_dim == DIM_BUFFER)
+                        return t->image_sampled == 2 ? VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER : VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER;
+                    return t->image_sampled == 2 ? VK_DESCRIPTOR_TYPE_STORAGE_IMAGE : VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+                }
+                case op::TYPE_STRUCT :
+                {
+                    if(storage == storage_class::STORAGE_BUFFER)
+                        return VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+                    auto d = deco(id);
+                    if(d && d->buffer_block)
+                        return VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+                    return VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+                }
+                default: return std::nullopt;
+                }
+            }
+
+            module_reflection build() const
+            {
+                if(!found_entry_point)
+                    THROW("SPIR-V module has no entry point");
+                module_reflection result{};
+                result.stage       = stage();
+                result.entry_point = entry_point;
+
+                for(const auto& var : variables)
+                {
+                    const auto& pointer = type(var.type);
+                    uint32_t pointee = pointer.component_type;
+                    auto d = deco(var.id);
+
+                    if(var.storage == storage_class::INPUT)
+                    {
+                        if(result.stage != VK_SHADER_STAGE_VERTEX_BIT || d == nullptr || d->built_in || !d->location)
+                            continue;
+                        const auto& t = type(pointee);
+                        uint32_t columns = 1;
+                        const type_info* column = &t;
+                        if(t.opcode == op::TYPE_MATRIX)     //a matrix takes one location per column
+                            columns = t.count, column = &type(t.component_type);
+                        const type_info& scalar  = column->opcode == op::TYPE_VECTOR ? type(column->component_type) : *column;
+                        uint32_t components      = column->opcode == op::TYPE_VECTOR ? column->count : 1;
+                        for(uint32_t c = 0; c < columns; ++c)
+                        {
+                            vertex_input input{};
+                            input.location = d->location.value() + c;
+                            input.format   = format_of(scalar, components);
+                            input.size     = components * (scalar.width / 8);
+                            input.name     = name_of(var.id);
+                            if(input.format == VK_FORMAT_UNDEFINED)
+                                INFORM_ERR("WARNING : unsupported vertex input type for " << input.name);
+                            result.inputs.push_back(input);
+                        }
+                    }
+                    else if(var.storage == storage_class::PUSH_CONSTANT)
+                    {
+                        const auto& t = type(pointee);
+                        uint32_t offset = UINT32_MAX;
+                        for(uint32_t m = 0; m < t.members.size(); ++m)
+                        {
+                            auto md = member_deco(pointee, m);
+                            offset = std::min(offset, (md && md->offset) ? md->offset.value() : 0u);
+                        }
+                        if(offset == UINT32_MAX)
+                            offset = 0;
+                        uint32_t end = size_of(pointee);
+                        result.push_constants = push_constant_block{offset, end - offset};
+                    }
+                    else if(var.storage == storage_class::UNIFORM_CONSTANT || var.storage == storage_class::UNIFORM
+                    || var.storage == storage_class::STORAGE_BUFFER)
+                    {
+                        if(d == nullptr || !d->binding)
+                            continue;
+                        uint32_t count;
+                        auto descriptor = descriptor_type(pointee, var.storage, count);
+                        if(!descriptor.has_value())
+                            continue;
+                        descriptor_binding binding{};
+                        binding.set     = d->set.value_or(0);
+                        binding.binding = d->binding.value();
+                        binding.type    = descriptor.value();
+                        binding.count   = count;
+                        binding.name    = name_of(var.id);
+                        result.bindings.push_back(binding);
+                    }
+                }
+                std::sort(result.inputs.begin(), result.inputs.end(), [](const vertex_input& a, const vertex_input& b)
+                {return a.location < b.location;});
+
+                for(auto id : spec_constant_ids)
+                {
+                    auto d = deco(id);
+                    if(d == nullptr || !d->spec_id)    //not a specialization constant, just an op on them
+                        continue;
+                    const auto& value = spec_constant_values.at(id);
+                    const auto& t = type(value.first);
+                    specialization_constant spec{};
+                    spec.id            = d->spec_id.value();
+                    spec.size          = t.opcode == op::TYPE_BOOL ? sizeof(VkBool32) : t.width / 8;
+                    spec.default_value = value.second;
+                    spec.name          = name_of(id);
+                    result.spec_constants.push_back(spec);
+                }
+                return result;
+            }
+        };
+    }
+
+    //parses byte code directly. Prefer reflect_cached
+    inline module_reflection reflect(const uint32_t* words, size_t word_count)
+    {
+        return detail::parser(words, word_count).parse();
+    }
+    inline uint64_t module_hash(const std::vector<char>& byte_code)
+    {
+        return hash_bytes(byte_code.data(), byte_code.size());
+    }
+    //parses each distinct module once. Safe to call from several threads
+    inline const module_reflection& reflect_cached(const std::vector<char>& byte_code)
+    {
+        static std::mutex lock;
+        static std::unordered_map<uint64_t, module_reflection> cache;
+
+        if(byte_code.size() % sizeof(uint32_t) != 0)
+            THROW("SPIR-V byte code of " + std::to_string(byte_code.size()) + " bytes isn't made of 32 bit words");
+        uint64_t hash = module_hash(byte_code);
+        std::lock_guard<std::mutex> guard(lock);
+        auto itr = cache.find(hash);
+        if(itr != cache.end())
+            return itr->second;
+        //byte code from std::vector<char> is suitably aligned for uint32_t (operator new alignment)
+        auto reflection = reflect(reinterpret_cast<const uint32_t*>(byte_code.data()), byte_code.size() / sizeof(uint32_t));
+        return cache.emplace(hash, std::move(reflection)).first->second;
+    }
+
+    //one interleaved binding, attributes tightly packed in location order
+    inline vk_handle::description::vertex_input_desc vertex_input(const module_reflection& vertex_stage, uint32_t binding = 0)
+    {
+        vk_handle::description::vertex_input_desc desc{};
+        if(vertex_stage.inputs.empty())
+            return desc;
+        uint32_t offset = 0;
+        for(const auto& input : vertex_stage.inputs)
+        {
+            VkVertexInputAttributeDescription attrib{};
+            attrib.binding  = binding;
+            attrib.location = input.location;
+            attrib.format   = input.format;
+            attrib.offset   = offset;
+            offset += input.size;
+            desc.attrib_descriptions.push_back(attrib);
+        }
+        VkVertexInputBindingDescription binding_desc{};
+        binding_desc.binding   = binding;
+        binding_desc.stride    = offset;
+        binding_desc.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+        desc.binding_descriptions.push_back(binding_desc);
+        return desc;
+    }
+
+    //{set, binding} -> how many descriptors a runtime array binding gets in the layout
+    typedef std::map<std::pair<uint32_t, uint32_t>, uint32_t> runtime_array_counts;
+
+    //bindings of all stages merged per set. Index i holds set i, unused sets are empty.
+    //every runtime array needs an entry in array_counts, the device needs runtimeDescriptorArray for them
+    inline std::vector<std::vector<VkDescriptorSetLayoutBinding>> set_layout_bindings(const std::vector<const module_reflection*>& stages,
+    const runtime_array_counts& array_counts = {})
+    {
+        std::map<std::pair<uint32_t, uint32_t>, VkDescriptorSetLayoutBinding> merged;
+        uint32_t set_count = 0;
+        for(const auto* stage : stages)
+            for(const auto& b : stage->bindings)
+            {
+                uint32_t count = b.count;
+                if(count == 0)
+                {
+                    auto sized = array_counts.find({b.set, b.binding});
+                    if(sized == array_counts.end() || sized->second == 0)
+                        THROW("set " + std::to_string(b.set) + " binding " + std::to_string(b.binding) +
+                        " is a runtime array, give it a count");
+                    count = sized->second;
+                }
+                auto [itr, inserted] = merged.insert({{b.set, b.binding}, VkDescriptorSetLayoutBinding{b.binding, b.type, count, 0, nullptr}});
+                if(!inserted && itr->second.descriptorType != b.type)
+                    INFORM_ERR("WARNING : stages disagree on descriptor type of set " << b.set << " binding " << b.binding);
+                itr->second.stageFlags |= stage->stage;
+                set_count = std::max(set_count, b.set + 1);
+            }
+        std::vector<std::vector<VkDescriptorSetLayoutBinding>> sets(set_count);
+        for(const auto& [key, binding] : merged)
+            sets[key.first].push_back(binding);
+        return sets;
+    }
+    //one range covering every stage's block
+    inline std::vector<VkPushConstantRange> push_constant_ranges(const std::vector<const module_reflection*>& stages)
+    {
+        std::optional<VkPushConstantRange> range;
+        for(const auto* stage : stages)
+        {
+            if(!stage->push_constants.has_value())
+                continue;
+            const auto& block = stage->push_constants.value();
+            if(!range.has_value())
+            {
+                range = VkPushConstantRange{static_cast<VkShaderStageFlags>(stage->stage), block.offset, block.size};
+                continue;
+            }
+            uint32_t begin = std::min(range->offset, block.offset);
+            uint32_t end   = std::max(range->offset + range->size, block.offset + block.size);
+            range->stageFlags |= stage->stage;
+            range->offset = begin, range->size = end - begin;
+        }
+        if(!range.has_value())
+            return {};
+        return {range.value()};
+    }
+    /*
+        push_descriptor_set picks the set whose layout is created for push descriptors, array_counts sizes runtime arrays.
+        The uniform and storage buffers of dynamic_buffer_set become their _DYNAMIC types, bound with an offset per draw
+    */
+    inline vk_handle::description::pipeline_layout_desc pipeline_layout(VkDevice device, const std::vector<const module_reflection*>& stages,
+    descriptor_layout_cache_t& layout_cache, std::optional<uint32_t> push_descriptor_set = std::nullopt,
+    const runtime_array_counts& array_counts = {}, std::optional<uint32_t> dynamic_buffer_set = std::nullopt)
+    {
+        if(push_descriptor_set.has_value() && push_descriptor_set == dynamic_buffer_set)
+            THROW("set " + std::to_string(push_descriptor_set.value()) + " can't be pushed and hold dynamic buffers");
+        vk_handle::description::pipeline_layout_desc desc{};
+        desc.parent = device;
+        for(auto& bindings : set_layout_bindings(stages, array_counts))
+        {
+            bool push = push_descriptor_set == desc.set_layouts.size();
+            if(dynamic_buffer_set == desc.set_layouts.size())
+                for(auto& binding : bindings)
+                    if(binding.descriptorType == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER)
+                        binding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+                    else if(binding.descriptorType == VK_DESCRIPTOR_TYPE_STORAGE_BUFFER)
+                        binding.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC;
+            desc.set_layouts.push_back(layout_cache.get(bindings, push ? VK_DESCRIPTOR_SET_LAYOUT_CREATE_PUSH_DESCRIPTOR_BIT_KHR : 0));
+        }
+        if(push_descriptor_set.has_value() && push_descriptor_set.value() >= desc.set_layouts.size())
+            THROW("push descriptor set " + std::to_string(push_descriptor_set.value()) + " isn't used by any stage");
+        if(dynamic_buffer_set.has_value() && dynamic_buffer_set.value() >= desc.set_layouts.size())
+            THROW("dynamic buffer set " + std::to_string(dynamic_buffer_set.value()) + " isn't used by any stage");
+        desc.push_descriptor_set = push_descriptor_set;
+        desc.push_constant_ranges = push_constant_ranges(stages);
+        return desc;
+    }
+}
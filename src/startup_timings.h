@@ -0,0 +1,54 @@
+#pragma once
+
+#include "debug.h"
+
+#include <chrono>
+#include <vector>
+
+/*
+    Wall clock time of every startup stage, for finding out where the time to first frame goes :
+
+        startup_timings_t timings;
+        context.start(true, false, &timings);   //marks its own stages
+        ...create the device
+        timings.mark("device");
+        ...
+        timings.report();
+
+    Every mark() closes the stage that began at the previous one, so the stages add up to the total.
+*/
+class startup_timings_t
+{
+public:
+    startup_timings_t() : start(clock::now()), last(start) {}
+
+    void mark(const char* stage)
+    {
+        auto now = clock::now();
+        stages.push_back(stage_t{stage, now - last});
+        last = now;
+    }
+    void report() const
+    {
+        INFORM("startup :");
+        for(const auto& stage : stages)
+            INFORM("    " << stage.name << " : " << milliseconds(stage.duration) << "ms");
+        INFORM("    total : " << milliseconds(last - start) << "ms");
+    }
+
+private:
+    typedef std::chrono::steady_clock clock;
+    struct stage_t
+    {
+        const char*             name;
+        clock::duration     duration;
+    };
+    static double milliseconds(clock::duration duration)
+    {
+        return std::chrono::duration<double, std::milli>(duration).count();
+    }
+
+    clock::time_point  start;
+    clock::time_point   last;
+    std::vector<stage_t> stages;
+};
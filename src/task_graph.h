@@ -0,0 +1,190 @@
+#pragma once
+
+#include "debug.h"
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <functional>
+#include <algorithm>
+
+/*
+    Runs a graph of one-shot tasks, each as soon as the tasks it depends on are done, on a few worker threads :
+
+        task_graph_t graph;
+        auto context = graph.add("context", {}, [&](){context.start();}, task_graph_t::MAIN_THREAD);
+        auto files   = graph.add("files", {}, [&](){...});               //overlaps the context
+        auto device  = graph.add("device", {context}, [&](){...});
+        graph.run();
+
+    MAIN_THREAD tasks run on the thread calling run(), for libraries like GLFW that insist on it; everything else
+    goes to the workers. A task can only depend on tasks added before it, so the graph can't have cycles.
+    A task that throws skips everything depending on it, run() then fails with its message.
+
+    Every task's start and duration is kept for report(), to see what the critical path is made of.
+*/
+class task_graph_t
+{
+public:
+    typedef uint32_t task_id;
+    typedef std::function<void ()> task_fnc;
+    enum affinity
+    {
+        ANY_THREAD,
+        MAIN_THREAD,
+    };
+
+    task_graph_t(uint32_t thread_count = std::min(4u, std::max(1u, std::thread::hardware_concurrency()))) :
+    thread_count(std::max(1u, thread_count))
+    {
+    }
+
+    task_id add(const char* name, std::vector<task_id> dependencies, task_fnc fnc, affinity where = ANY_THREAD)
+    {
+        task_id id = static_cast<task_id>(tasks.size());
+        for(auto dependency : dependencies)
+            if(dependency >= id)
+                THROW(std::string("task ") + name + " depends on a task added after it");
+        tasks.push_back(task{name, std::move(fnc), where, static_cast<uint32_t>(dependencies.size())});
+        for(auto dependency : dependencies)
+            tasks[dependency].dependents.push_back(id);
+        return id;
+    }
+
+    //blocks until every task ran or was skipped
+    bool run(const bool throws = true)
+    {
+        start = clock::now();
+        completed = 0;
+        for(task_id i = 0; i < tasks.size(); ++i)
+            if(tasks[i].remaining == 0)
+                push_ready(i);
+
+        std::vector<std::thread> workers;
+        for(uint32_t i = 0; i < thread_count; ++i)
+            workers.emplace_back([this](){work(ANY_THREAD);});
+        work(MAIN_THREAD);
+        for(auto& worker : workers)
+            worker.join();
+
+        EXIT_IF(!error.empty(), error, DO_NOTHING);
+        return true;
+    }
+
+    //since run() started
+    double elapsed_ms() const
+    {
+        return milliseconds(clock::now() - start);
+    }
+    void report() const
+    {
+        std::vector<const task*> order;
+        for(const auto& t : tasks)
+            order.push_back(&t);
+        std::sort(order.begin(), order.end(), [](const task* a, const task* b){return a->began < b->began;});
+        INFORM("startup tasks :");
+        clock::time_point end = start;
+        for(const auto* t : order)
+        {
+            if(t->skipped)
+            {
+                INFORM("    " << t->name << " : skipped");
+                continue;
+            }
+            INFORM("    " << t->name << " : " << milliseconds(t->began - start) << "ms + " << milliseconds(t->finished - t->began) << "ms"
+            << (t->where == MAIN_THREAD ? " (main thread)" : ""));
+            end = std::max(end, t->finished);
+        }
+        INFORM("    all done after " << milliseconds(end - start) << "ms");
+    }
+
+private:
+    typedef std::chrono::steady_clock clock;
+    struct task
+    {
+        const char*               name;
+        task_fnc                   fnc;
+        affinity                 where;
+        uint32_t             remaining;
+        std::vector<task_id> dependents{};
+        bool               skipped = false;
+        clock::time_point  began{}, finished{};
+    };
+
+    static double milliseconds(clock::duration duration)
+    {
+        return std::chrono::duration<double, std::milli>(duration).count();
+    }
+
+    void push_ready(task_id id)
+    {
+        (tasks[id].where == MAIN_THREAD ? main_ready : any_ready).push_back(id);
+    }
+    void work(affinity where)
+    {
+        auto& ready = where == MAIN_THREAD ? main_ready : any_ready;
+        while(true)
+        {
+            task_id id;
+            {
+                std::unique_lock<std::mutex> guard(lock);
+                wake.wait(guard, [&](){return !ready.empty() || completed == tasks.size();});
+                if(ready.empty())
+                    return;
+                id = ready.front();
+                ready.pop_front();
+            }
+            execute(tasks[id]);
+            finish(id);
+        }
+    }
+    void execute(task& t)
+    {
+        t.began = clock::now();
+        if(!t.skipped)
+        {
+            try
+            {
+                t.fnc();
+            }
+            catch(const std::exception& e)
+            {
+                std::lock_guard<std::mutex> guard(lock);
+                t.skipped = true;   //as far as its dependents are concerned
+                if(error.empty())
+                    error = std::string(t.name) + " : " + e.what();
+            }
+        }
+        t.finished = clock::now();
+    }
+    void finish(task_id id)
+    {
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            for(auto dependent : tasks[id].dependents)
+            {
+                auto& d = tasks[dependent];
+                d.skipped = d.skipped || tasks[id].skipped;
+                if(--d.remaining == 0)
+                    push_ready(dependent);
+            }
+            completed++;
+        }
+        wake.notify_all();
+    }
+
+    std::vector<task>           tasks;
+    uint32_t             thread_count;
+
+    std::mutex                   lock;
+    std::condition_variable      wake;
+    std::deque<task_id>     any_ready;
+    std::deque<task_id>    main_ready;
+    size_t              completed = 0;
+    std::string                 error;
+    clock::time_point           start;
+};
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "volk.h"
+#include "glm/glm.hpp"
+
+#include <array>
+#include <cstddef>
+
+/*
+    Vertex input state derived from the vertex struct at compile time. Members are listed once :
+
+        template<> struct vertex_layout<vertex>
+        {
+            static constexpr std::array fields{VERTEX_FIELD(vertex, pos), VERTEX_FIELD(vertex, color)};
+        };
+
+    Field i goes to location i. Formats come from the member types, offsets from offsetof, so neither can drift
+    from the struct. vertex_attributes and vertex_binding are constexpr arrays with static storage, and can be handed
+    to vertex_input_desc::static_*_descriptions without allocating.
+*/
+template<typename T> struct vertex_format;  //undefined for unsupported types, specialize to add your own
+
+template<> struct vertex_format<float>      {static constexpr VkFormat value = VK_FORMAT_R32_SFLOAT;};
+template<> struct vertex_format<glm::vec2>  {static constexpr VkFormat value = VK_FORMAT_R32G32_SFLOAT;};
+template<> struct vertex_format<glm::vec3>  {static constexpr VkFormat value = VK_FORMAT_R32G32B32_SFLOAT;};
+template<> struct vertex_format<glm::vec4>  {static constexpr VkFormat value = VK_FORMAT_R32G32B32A32_SFLOAT;};
+template<> struct vertex_format<int32_t>    {static constexpr VkFormat value = VK_FORMAT_R32_SINT;};
+template<> struct vertex_format<glm::ivec2> {static constexpr VkFormat value = VK_FORMAT_R32G32_SINT;};
+template<> struct vertex_format<glm::ivec3> {static constexpr VkFormat value = VK_FORMAT_R32G32B32_SINT;};
+template<> struct vertex_format<glm::ivec4> {static constexpr VkFormat value = VK_FORMAT_R32G32B32A32_SINT;};
+template<> struct vertex_format<uint32_t>   {static constexpr VkFormat value = VK_FORMAT_R32_UINT;};
+template<> struct vertex_format<glm::uvec2> {static constexpr VkFormat value = VK_FORMAT_R32G32_UINT;};
+template<> struct vertex_format<glm::uvec3> {static constexpr VkFormat value = VK_FORMAT_R32G32B32_UINT;};
+template<> struct vertex_format<glm::uvec4> {static constexpr VkFormat value = VK_FORMAT_R32G32B32A32_UINT;};
+template<> struct vertex_format<double>     {static constexpr VkFormat value = VK_FORMAT_R64_SFLOAT;};
+template<> struct vertex_format<glm::dvec2> {static constexpr VkFormat value = VK_FORMAT_R64G64_SFLOAT;};
+template<> struct vertex_format<glm::dvec3> {static constexpr VkFormat value = VK_FORMAT_R64G64B64_SFLOAT;};
+template<> struct vertex_format<glm::dvec4> {static constexpr VkFormat value = VK_FORMAT_R64G64B64A64_SFLOAT;};
+
+struct vertex_field
+{
+    uint32_t offset;
+    VkFormat format;
+};
+#define VERTEX_FIELD(vertex_t, member) \
+vertex_field{static_cast<uint32_t>(offsetof(vertex_t, member)), vertex_format<decltype(vertex_t::member)>::value}
+
+template<typename vertex_t> struct vertex_layout;   //specialize with a constexpr std::array<vertex_field, N> fields
+
+namespace detail
+{
+    template<typename vertex_t> consteval auto make_vertex_attributes(uint32_t binding)
+    {
+        constexpr auto& fields = vertex_layout<vertex_t>::fields;
+        std::array<VkVertexInputAttributeDescription, fields.size()> attribs{};
+        for(uint32_t i = 0; i < fields.size(); ++i)
+            attribs[i] = VkVertexInputAttributeDescription{i, binding, fields[i].format, fields[i].offset};
+        return attribs;
+    }
+}
+
+template<typename vertex_t, uint32_t binding = 0>
+constexpr auto vertex_attributes = detail::make_vertex_attributes<vertex_t>(binding);
+
+template<typename vertex_t, uint32_t binding = 0, VkVertexInputRate input_rate = VK_VERTEX_INPUT_RATE_VERTEX>
+constexpr std::array<VkVertexInputBindingDescription, 1> vertex_binding{
+    VkVertexInputBindingDescription{binding, static_cast<uint32_t>(sizeof(vertex_t)), input_rate}};
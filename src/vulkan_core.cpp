@@ -8,9 +8,30 @@
 #include "vulkan_data_getters.h"
 #include "debug.h"
 #include "read_file.h"
+#include "async_compute.h"
+#include "push_constants.h"
+#include "bindless_heap.h"
+#include "push_descriptors.h"
+#include "spirv_reflect.h"
+#include "vertex_layout.h"
+#include "pipeline_compiler.h"
+#include "pipeline_manifest.h"
+#include "pipeline_library.h"
+#include "dynamic_state.h"
+#include "shader_object.h"
+#include "specialization.h"
+#include "readback.h"
+#include "startup_timings.h"
+#include "task_graph.h"
+#include "device_probe.h"
+#include "embedded_shaders.h"
 
 #include <map>
 #include <algorithm>
+#include <chrono>
+#include <thread>
+#include <cstring>
+#include <cctype>
 
 
 typedef unsigned int uint; //MSVC can't handle the power of pure uint
@@ -101,20 +122,27 @@ class vulkan_context
 
     //Initializes all third party dependencies, as well as the Vulkan instanc and debugger, and determines physical devices.
     //In case of failure, returns false, and, if throws is set, throws runtime error.
-    static bool init(bool throws = true)
+    //Headless skips GLFW entirely, for machines without a display. timings, if given, gets a mark per stage.
+    static bool init(bool throws = true, bool headless = false, startup_timings_t* timings = nullptr)
     {
         if(INIT)
             return true;
+        auto mark = [timings](const char* stage){if(timings != nullptr) timings->mark(stage);};
 
         //this is vulkan baby
-        glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
-        EXIT_IF(glfwInit() == GLFW_FALSE, "GLFW INIT FAILED", terminate);
+        if(!headless)
+        {
+            glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
+            EXIT_IF(glfwInit() == GLFW_FALSE, "GLFW INIT FAILED", terminate);
 
-        TERMINATION_QUEUE.push(DO(glfwTerminate();));
+            TERMINATION_QUEUE.push(DO(glfwTerminate();));
+            mark("context : glfw");
+        }
         
         EXIT_IF(volkInitialize(), "VOLK INIT FAILED", terminate);
 
         TERMINATION_QUEUE.push(DO(volkFinalize();));
+        mark("context : loader");
 
         data::instance_desc description{};
         try
@@ -122,7 +150,8 @@ class vulkan_context
             uint debug_flag = 0;
             if(DEBUG_MODE)
                 debug_flag = get::instance::DEBUG;
-            description = get::instance::get_instance_description(get::instance::GLFW | debug_flag, debug_flag);
+            uint window_flag = headless ? 0 : get::instance::GLFW;
+            description = get::instance::get_instance_description(window_flag | debug_flag, debug_flag);
         }
         catch(const std::exception& e)
         {
@@ -132,22 +161,28 @@ class vulkan_context
         //EXIT_IF(VULKAN.init(description), "VULKAN INSTANTIATION FAILED", terminate);
         
         TERMINATION_QUEUE.push(DO(delete VULKAN;));
+        //capability snapshots are keyed by this instance's physical devices
+        TERMINATION_QUEUE.push(DO(vk::device_capabilities_t::clear();));
 
         volkLoadInstance(*VULKAN);
+        mark("context : instance");
 
         if(DEBUG_MODE)
         {
             vk::debug_messenger* lifetime_extension = new vk::debug_messenger(data::debug_messenger_desc{*VULKAN, get_debug_create_info()});
             TERMINATION_QUEUE.push(DO(delete lifetime_extension;));
+            mark("context : debug messenger");
         }
 
-        //check for swapchain support by default
+        //check for swapchain support by default, headless devices never present
         auto candidates = get::physical_device::find_physical_devices(*VULKAN);
         for(const auto& candidate : candidates)
-            if(get::physical_device::supports_extensions(candidate, get::physical_device::get_required_extension_names(get::physical_device::SWAPCHAIN)))
+            if(headless ||
+            get::physical_device::supports_extensions(candidate, get::physical_device::get_required_extension_names(get::physical_device::SWAPCHAIN)))
                 PHYSICAL_DEVICES.push_back(candidate);
 
         EXIT_IF(PHYSICAL_DEVICES.size() == 0, "FAILED TO FIND PHYSICAL DEVICE", terminate);
+        mark("context : physical devices");
 
         INIT = true;
 
@@ -163,7 +198,7 @@ class vulkan_context
     static unsigned int copies;
 public:
     vulkan_context() {vulkan_context::copies++;}
-    bool start(bool throws = true){return init(throws);}
+    bool start(bool throws = true, bool headless = false, startup_timings_t* timings = nullptr){return init(throws, headless, timings);}
     ~vulkan_context()
     {
         if(copies == 1)
@@ -179,6 +214,10 @@ struct vertex
     glm::vec2   pos;
     glm::vec3 color;
 };
+template<> struct vertex_layout<vertex>
+{
+    static constexpr std::array fields{VERTEX_FIELD(vertex, pos), VERTEX_FIELD(vertex, color)};
+};
 const std::vector<vertex> TRIANGLE_VERTICES = {
     {{-0.5f, -0.5f}, {1.0f, 0.0f, 0.0f}},
     {{0.5f, -0.5f}, {0.0f, 1.0f, 0.0f}},
@@ -189,35 +228,261 @@ const std::vector<uint32_t> INDICES = {
     0, 1, 2, 2, 3, 0
 };
 
-template <typename vertex_t> VkVertexInputBindingDescription get_per_vertex_binding_description(uint32_t binding)
+//written on exit, read on the next startup
+const char* PIPELINE_MANIFEST_PATH = "pipelines.manifest";
+const char* PIPELINE_CACHE_PATH    = "pipeline_cache.bin";
+const char* DEVICE_PROBE_PATH      = "device_probe.cache";
+
+//what the last session left behind, read ahead so startup can overlap the disk with device creation
+struct pipeline_files_t
 {
-    VkVertexInputBindingDescription description{};
+    std::vector<char>    cache_data;
+    std::vector<char> manifest_data;
 
-    description.binding = binding;
-    description.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
-    description.stride = sizeof(vertex_t);
+    //a missing or stale file just means an empty cache
+    static pipeline_files_t read()
+    {
+        pipeline_files_t files;
+        read_binary_file(PIPELINE_CACHE_PATH, files.cache_data);
+        read_binary_file(PIPELINE_MANIFEST_PATH, files.manifest_data);
+        return files;
+    }
+};
 
+//shader is compiled into the binary at build time, embedded_shaders::get("name.spv") finds it, see shaders/embed_spirv.cmake
+static data::shader_module_desc get_shader_desc(const embedded_shaders::entry& shader, VkShaderStageFlagBits stage_bits, 
+const vk::device& device)
+{
+    //these need to stay alive until the pipeline is created!
+    data::shader_module_desc description{};
+    const char* bytes = reinterpret_cast<const char*>(shader.code);
+    description.byte_code.assign(bytes, bytes + shader.size);
+    description.entry_point_name = "main";
+    description.parent = device;
+    description.stage = stage_bits;
     return description;
 }
-template <typename vertex_t> std::vector<VkVertexInputAttributeDescription> get_attrib_description(uint32_t binding);
-template<> 
-std::vector<VkVertexInputAttributeDescription> get_attrib_description<vertex> (uint32_t binding)
-{
-    std::vector<VkVertexInputAttributeDescription> descriptions(2);
-    descriptions[0].binding  = binding, descriptions[1].binding  = binding;
-    descriptions[0].location = 0      , descriptions[1].location = 1;
-    descriptions[0].format   = VK_FORMAT_R32G32_SFLOAT      , descriptions[1].format = VK_FORMAT_R32G32B32_SFLOAT;
-    descriptions[0].offset   = offsetof(vertex, vertex::pos), descriptions[1].offset = offsetof(vertex, vertex::color);
-    return descriptions;
+//buffers touched by the graphics and the compute queue are shared between both families
+static std::vector<uint32_t> graphics_and_compute_families(const vk::device& device)
+{
+    uint32_t graphics = device.description.graphics_queue.fam_idx, compute = device.description.compute_queue.fam_idx;
+    if(graphics == compute)
+        return {graphics};
+    return {graphics, compute};
 }
 
+/*
+    Spins the triangle on the compute queue : shaders/animate.comp rotates the uploaded vertices into a copy per
+    command buffer, and the frame draws from its own copy. A dispatch never writes a copy an earlier frame is still
+    drawing from, since the frame's fence has signalled by the time its index comes round again, and the frame waits
+    for the dispatch through render_data_t::async_compute.
+
+    With descriptor indexing every buffer gets a slot in a bindless heap once, and animate_bindless.comp picks them
+    by index from the push constants. Otherwise each dispatch writes a set from the frame's descriptor allocator.
+*/
+struct vertex_animation_t
+{
+    struct animation_data
+    {
+        uint32_t vertex_count;
+        float           angle;  //radians
+        uint32_t       source;  //heap indices, bindless only
+        uint32_t  destination;
+    };
+    typedef push_constant_t<animation_data, VK_SHADER_STAGE_COMPUTE_BIT> animation_push;
+
+    std::optional<bindless_heap_t>     heap;
+    vk::shader_module                shader;
+    vk::pipeline_layout              layout;
+    vk::compute_pipeline           pipeline;
+    animation_push                     push;
+    async_compute_t                 compute;
+    VkBuffer                         source;
+    std::vector<vk::buffer> vertex_buffers;   //one per command buffer
+    //heap slots of source and vertex_buffers, in that order
+    std::vector<uint32_t>      heap_indices;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    //source needs VK_BUFFER_USAGE_STORAGE_BUFFER_BIT
+    vertex_animation_t(const vk::device& device, VmaAllocator allocator, uint32_t buffer_count, VkBuffer source,
+    descriptor_layout_cache_t& layout_cache) :
+    heap(get_heap(device, buffer_count)),
+    shader(get_shader_desc(heap.has_value() ? embedded_shaders::get("animate_bindless_comp.spv") : embedded_shaders::get("animate_comp.spv"),
+    VK_SHADER_STAGE_COMPUTE_BIT, device)),
+    layout(get_layout_desc(device, shader, heap, layout_cache)),
+    pipeline({get_pipeline_desc(device, shader, layout)}),
+    push(layout, device.description.phys_device),
+    compute(device, buffer_count),
+    source(source)
+    {
+        vertex_buffers.reserve(buffer_count);
+        for(uint32_t i = 0; i < buffer_count; ++i)
+            vertex_buffers.emplace_back(data::buffer_desc
+            {
+                .parent    = device,
+                .allocator = allocator,
+                .alloc_info = VmaAllocationCreateInfo
+                {
+                    .usage = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE,
+                    .pool = VK_NULL_HANDLE
+                },
+                .size  = sizeof(vertex) * TRIANGLE_VERTICES.size(),
+                .usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                .queue_fam_indices = graphics_and_compute_families(device)
+            });
+        if(!heap.has_value())
+            return;
+        heap_indices.push_back(heap->add_buffer(source, 0, VK_WHOLE_SIZE));
+        for(const auto& buffer : vertex_buffers)
+            heap_indices.push_back(heap->add_buffer(buffer, 0, VK_WHOLE_SIZE));
+    }
+
+    //submits the dispatch for frame_index and returns the buffer it writes, the frame's submission must wait on compute
+    VkBuffer animate(uint32_t frame_index, descriptor_allocator_t& sets)
+    {
+        std::chrono::duration<float> time = std::chrono::steady_clock::now() - start;
+        animation_data animation{static_cast<uint32_t>(TRIANGLE_VERTICES.size()), time.count(), 0, 0};
+        VkDescriptorSet set = VK_NULL_HANDLE;
+        if(heap.has_value())
+            animation.source = heap_indices[0], animation.destination = heap_indices[frame_index + 1];
+        else
+            set = write_set(frame_index, sets);
+
+        compute.submit([&](VkCommandBuffer cmd)
+        {
+            vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline.handle[0]);
+            if(heap.has_value())
+                heap->bind(cmd, layout, VK_PIPELINE_BIND_POINT_COMPUTE);
+            else
+                vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, layout, 0, 1, &set, 0, nullptr);
+            push.push(cmd, animation);
+            vkCmdDispatch(cmd, (animation.vertex_count + LOCAL_SIZE - 1) / LOCAL_SIZE, 1, 1);
+        });
+        return vertex_buffers[frame_index];
+    }
+
+private:
+    static constexpr uint32_t LOCAL_SIZE = 64;  //local_size_x in animate.comp
+    VkDescriptorSet write_set(uint32_t frame_index, descriptor_allocator_t& sets) const
+    {
+        VkDescriptorSet set = sets.allocate(frame_index, layout.description.set_layouts[0]);
+        std::array<VkDescriptorBufferInfo, 2> buffers{VkDescriptorBufferInfo{source, 0, VK_WHOLE_SIZE},
+        VkDescriptorBufferInfo{vertex_buffers[frame_index], 0, VK_WHOLE_SIZE}};
+        std::array<VkWriteDescriptorSet, 2> writes{};
+        for(uint32_t i = 0; i < writes.size(); ++i)
+        {
+            writes[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            writes[i].dstSet = set, writes[i].dstBinding = i;
+            writes[i].descriptorCount = 1, writes[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            writes[i].pBufferInfo = &buffers[i];
+        }
+        vkUpdateDescriptorSets(layout.description.parent, static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
+        return set;
+    }
+    static std::optional<bindless_heap_t> get_heap(const vk::device& device, uint32_t buffer_count)
+    {
+        if(!device.description.descriptor_indexing_features.has_value())
+            return std::nullopt;
+        //the source and one buffer per frame, nothing else lives in this heap
+        return std::optional<bindless_heap_t>(std::in_place, device, buffer_count, bindless_heap_t::capacity{buffer_count + 1, 1, 1});
+    }
+    static data::pipeline_layout_desc get_layout_desc(VkDevice device, const vk::shader_module& shader,
+    const std::optional<bindless_heap_t>& heap, descriptor_layout_cache_t& layout_cache)
+    {
+        if(!heap.has_value())
+            return spirv::pipeline_layout(device, {&spirv::reflect_cached(shader.description.byte_code)}, layout_cache);
+        data::pipeline_layout_desc desc{};
+        desc.parent = device;
+        desc.set_layouts = {heap->get_set_layout()};
+        desc.push_constant_ranges = {animation_push::range};
+        return desc;
+    }
+    static data::compute_pipeline_desc get_pipeline_desc(VkDevice device, const vk::shader_module& shader, VkPipelineLayout layout)
+    {
+        data::compute_pipeline_desc desc{};
+        desc.parent = device;
+        desc.pipeline_layout = layout;
+        desc.shader_stage_info.module      = shader;
+        desc.shader_stage_info.entry_point = shader.description.entry_point_name;
+        desc.shader_stage_info.stage       = VK_SHADER_STAGE_COMPUTE_BIT;
+        return desc;
+    }
+};
+
+/*
+    Whatever the pipelines carry over between sessions : the driver's cache, the manifest of every pipeline compiled
+    through the compiler, and what the last session's manifest warmed up.
+
+        pipeline_state_t pipelines(device, files.cache_data);
+        pipelines.warm_up(device, files.manifest_data, renderpass, layout, {vertex_shader, fragment_shader});
+        async_pipeline_t pipeline = pipelines.compiler.compile(desc);
+        ...
+        pipelines.save();   //once the device is idle
+*/
+struct pipeline_state_t
+{
+    vk::pipeline_cache             cache;
+    pipeline_manifest_t            manifest;
+    //compiled in the background, frames skip the draw until it is ready
+    pipeline_compiler_t            compiler;
+    std::vector<async_pipeline_t>  warm_pipelines;
+
+    pipeline_state_t(VkDevice device, std::vector<char> cache_data) : cache(get_cache_desc(device, std::move(cache_data)))
+    {
+        compiler.set_compile_hook([this](data::graphics_pipeline_desc& desc){manifest.record(desc);});
+        //everything the last session created gets queued before it's asked for, and asking for it picks up the queued one
+        compiler.set_key([this](const data::graphics_pipeline_desc& desc){return manifest.key(desc);});
+    }
+    //the manifest only knows the renderpass, layout and shaders it was told about, as id 0
+    void warm_up(VkDevice device, const std::vector<char>& manifest_data, VkRenderPass renderpass, VkPipelineLayout layout,
+    const std::vector<std::reference_wrapper<vk::shader_module>>& shaders)
+    {
+        manifest.set_renderpass(0, renderpass);
+        manifest.set_layout(0, layout);
+        for(const auto& shader : shaders)
+            manifest.add_shader(shader.get());
+        if(manifest.load(manifest_data, PIPELINE_MANIFEST_PATH))
+            warm_pipelines = manifest.warm_up(device, compiler, cache);
+    }
+    //call once the device is idle
+    void save() const
+    {
+        if(!manifest.save(PIPELINE_MANIFEST_PATH))
+            INFORM_ERR("WARNING : failed to write " << PIPELINE_MANIFEST_PATH);
+        auto cache_data = get::pipeline_cache::get_data(cache.description.parent, cache);
+        std::ofstream file(PIPELINE_CACHE_PATH, std::ios::binary | std::ios::trunc);
+        file.write(cache_data.data(), cache_data.size());
+    }
+
+    private:
+    static data::pipeline_cache_desc get_cache_desc(VkDevice device, std::vector<char> cache_data)
+    {
+        data::pipeline_cache_desc desc{};
+        desc.parent = device;
+        desc.initial_data = std::move(cache_data);
+        return desc;
+    }
+};
 
 struct render_data_t
 {
     vk::shader_module              fragment_shader;
     vk::shader_module                vertex_shader;
+    descriptor_layout_cache_t         layout_cache;
+    //sets that only live for a frame. The render callbacks get a const render_data_t, and reset their frame's pools
+    //once its fence has signalled
+    mutable descriptor_allocator_t    descriptor_allocator;
     vk::pipeline_layout            pipeline_layout;
-    vk::graphics_pipeline          graphics_pipeline;
+    pipeline_state_t               pipelines;
+    //whatever the device can't set dynamically stays baked into the pipeline
+    draw_state_t                   draw_state;
+    std::vector<VkDynamicState>    dynamic_states;
+    //triangle.frag's constants, every stage of the triangle pipeline points into it
+    specialization_constants_t     triangle_constants;
+    //compiled by pipelines.compiler, frames skip the draw until it is ready
+    async_pipeline_t               graphics_pipeline;
+    //used instead of graphics_pipeline when the device has VK_EXT_shader_object
+    std::optional<shader_object_pipeline_t> shader_objects;
 
     vk::cmd_pool                   command_pool;
     vk::cmd_buffers                command_buffers;
@@ -226,36 +491,63 @@ struct render_data_t
 
     vk::buffer vertex_buffer;
     vk::buffer index_buffer;
+
+    //optional, graphics submissions wait on its latest result
+    async_compute_t*               async_compute = nullptr;
+    //set by start_animation(), points async_compute at its queue. Dispatched from the render callbacks
+    mutable std::optional<vertex_animation_t> animation;
     
-    render_data_t(const vk::device& device, VkRenderPass renderpass, uint concurrent_cmd_buffers, vk::buffer& v_buffer,
-    vk::buffer& index_buffer) : 
-    fragment_shader(get_shader_desc("triangle_frag.spv", VK_SHADER_STAGE_FRAGMENT_BIT, device)),
-    vertex_shader(get_shader_desc("triangle_vert.spv", VK_SHADER_STAGE_VERTEX_BIT, device)),
-    pipeline_layout(data::pipeline_layout_desc{device}),
-    graphics_pipeline({get_pipeline_desc(renderpass, pipeline_layout, {vertex_shader, fragment_shader}, device)}),
+    //rendering is set when the frame uses dynamic rendering, renderpass is VK_NULL_HANDLE then
+    render_data_t(const vk::device& device, VkRenderPass renderpass, std::optional<data::rendering_desc> rendering,
+    uint concurrent_cmd_buffers, vk::buffer& v_buffer, vk::buffer& index_buffer, pipeline_files_t files = pipeline_files_t::read()) : 
+    fragment_shader(get_shader_desc(embedded_shaders::get("triangle_frag.spv"), VK_SHADER_STAGE_FRAGMENT_BIT, device)),
+    vertex_shader(get_shader_desc(embedded_shaders::get("triangle_vert.spv"), VK_SHADER_STAGE_VERTEX_BIT, device)),
+    layout_cache(device),
+    descriptor_allocator(device, concurrent_cmd_buffers, {{VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1.0f},
+    {VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1.0f}, {VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1.0f}}),
+    pipeline_layout(spirv::pipeline_layout(device, {&spirv::reflect_cached(vertex_shader.description.byte_code),
+    &spirv::reflect_cached(fragment_shader.description.byte_code)}, layout_cache)),
+    pipelines(device, std::move(files.cache_data)),
+    graphics_pipeline(start_pipeline_compiles(device, renderpass, rendering, files.manifest_data)),
     command_pool(data::cmd_pool_desc{.parent = device, .queue_fam_index = device.description.graphics_queue.fam_idx, 
     .flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT}),
     command_buffers(data::cmd_buffers_desc{device, command_pool, concurrent_cmd_buffers, VK_COMMAND_BUFFER_LEVEL_PRIMARY}),
     vertex_buffer(std::move(v_buffer)), index_buffer(std::move(index_buffer))
     {
         submit_queue = get::device::queue_handle(device, device.description.graphics_queue);
+        //nothing to compile, draws start with the first frame
+        if(device.description.shader_object_features.has_value() && rendering.has_value())
+        {
+            auto desc = get_pipeline_desc(VK_NULL_HANDLE, pipeline_layout, {vertex_shader, fragment_shader}, device);
+            specialize(desc, triangle_constants);
+            shader_objects.emplace(device, pipeline_layout.description, std::vector<std::reference_wrapper<vk::shader_module>>{vertex_shader,
+            fragment_shader}, desc);
+        }
+    }
+    void start_animation(const vk::device& device, VmaAllocator allocator)
+    {
+        animation.emplace(device, allocator, command_buffers.description.buffer_count, vertex_buffer, layout_cache);
+        async_compute = &animation->compute;
     }
     
     private:
-    static data::shader_module_desc get_shader_desc(const char* filename, VkShaderStageFlagBits stage_bits, const vk::device& device)
-    {
-        //these need to stay alive until the graphics pipeline is created!
-        data::shader_module_desc description{};
-        std::vector<char> byte_code;
-        //"triangle_no_input_frag.spv"
-        read_binary_file({"shaders/"}, filename, byte_code);
-        description.byte_code = byte_code;
-        description.entry_point_name = "main";
-        description.parent = device;
-        description.stage = stage_bits;
-        return description;
+    async_pipeline_t start_pipeline_compiles(const vk::device& device, VkRenderPass renderpass, 
+    std::optional<data::rendering_desc> rendering, const std::vector<char>& manifest_data)
+    {
+        pipelines.warm_up(device, manifest_data, renderpass, pipeline_layout, {vertex_shader, fragment_shader});
+
+        triangle_constants.set(spirv::reflect_cached(fragment_shader.description.byte_code), "BRIGHTNESS", 1.0f);
+        auto desc = get_pipeline_desc(renderpass, pipeline_layout, {vertex_shader, fragment_shader}, device);
+        specialize(desc, triangle_constants);
+        desc.rendering      = rendering;
+        desc.pipeline_cache = pipelines.cache;
+        draw_state = draw_state_t::from(desc);
+        make_dynamic(desc, extended_dynamic_states(device.description));
+        dynamic_states = desc.dynamic_state_info.dynamic_state_list;
+        return pipelines.compiler.compile(desc);
     }
-    
+    public:
+    //the triangle pipeline, benchmarks swap shaders and layouts in and out of it
     static data::graphics_pipeline_desc get_pipeline_desc(VkRenderPass renderpass, VkPipelineLayout layout, 
     const std::vector<std::reference_wrapper<vk::shader_module>> shaders, VkDevice device)
     {
@@ -297,8 +589,20 @@ struct render_data_t
             triangle_pipeline_d.viewport_state_info.scissors.resize(1);
             triangle_pipeline_d.viewport_state_info.viewports.resize(1);
 
-            triangle_pipeline_d.vertex_input_info.attrib_descriptions  = get_attrib_description<vertex>(0);
-            triangle_pipeline_d.vertex_input_info.binding_descriptions.push_back(get_per_vertex_binding_description<vertex>(0));
+            triangle_pipeline_d.vertex_input_info.static_attrib_descriptions  = vertex_attributes<vertex>;
+            triangle_pipeline_d.vertex_input_info.static_binding_descriptions = vertex_binding<vertex>;
+            //the layout comes from the struct, the shader only gets to check it
+            for(const auto& shader : shaders)
+            {
+                if(shader.get().description.stage != VK_SHADER_STAGE_VERTEX_BIT)
+                    continue;
+                for(const auto& input : spirv::reflect_cached(shader.get().description.byte_code).inputs)
+                {
+                    const auto& attribs = vertex_attributes<vertex>;
+                    if(input.location >= attribs.size() || attribs[input.location].format != input.format)
+                        INFORM_ERR("WARNING : vertex shader input " << input.name << " doesn't match the layout of vertex");
+                }
+            }
 
             triangle_pipeline_d.parent = device;
             triangle_pipeline_d.pipeline_layout = layout;
@@ -307,54 +611,378 @@ struct render_data_t
     }
 
 };
-typedef std::function<bool (VkSemaphore, VkFence, const VkSemaphore, const VkRenderPassBeginInfo, uint , const render_data_t&, const bool)> 
+/*
+    With dynamic rendering there is no renderpass or framebuffer : the frame leaves both VK_NULL_HANDLE in the begin info
+    and hands one of these along with it instead. Render callbacks use begin_frame_rendering()/end_frame_rendering(),
+    which handle either case, in place of vkCmdBeginRenderPass()/vkCmdEndRenderPass().
+*/
+struct dynamic_rendering_target
+{
+    VkRenderingInfoKHR                      info;
+    VkRenderingAttachmentInfoKHR color_attachment;
+    VkImage                                 image;  //behind color_attachment
+    VkImageLayout                    final_layout;  //PRESENT_SRC for a swapchain, TRANSFER_SRC for headless images
+};
+//what a render callback draws into, begin_info.renderArea is the area either way
+struct frame_target
+{
+    VkRenderPassBeginInfo                begin_info;
+    const dynamic_rendering_target* rendering = nullptr;  //set when begin_info has no renderpass
+};
+typedef std::function<bool (VkSemaphore, VkFence, const VkSemaphore, const frame_target&, uint , const render_data_t&, const bool)> 
 frame_render_callback_fnc;
+static void transition_target_image(VkCommandBuffer cmd_buffer, const dynamic_rendering_target& target, bool finished)
+{
+    //same dependencies the frame renderpass declares
+    VkImageMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED, barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = target.image;
+    barrier.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1};
+    VkPipelineStageFlags src_stage = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, dst_stage = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+    if(finished)
+    {
+        barrier.oldLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, barrier.newLayout = target.final_layout;
+        barrier.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT, barrier.dstAccessMask = 0;
+        dst_stage = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
+        if(target.final_layout == VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL)
+            barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT, dst_stage = VK_PIPELINE_STAGE_TRANSFER_BIT;
+    }
+    else
+    {
+        barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED, barrier.newLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+        barrier.srcAccessMask = 0, barrier.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+    }
+    vkCmdPipelineBarrier(cmd_buffer, src_stage, dst_stage, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+}
+void begin_frame_rendering(VkCommandBuffer cmd_buffer, const frame_target& target)
+{
+    if(target.rendering == nullptr)
+    {
+        vkCmdBeginRenderPass(cmd_buffer, &target.begin_info, VK_SUBPASS_CONTENTS_INLINE);
+        return;
+    }
+    transition_target_image(cmd_buffer, *target.rendering, false);
+    vkCmdBeginRenderingKHR(cmd_buffer, &target.rendering->info);
+}
+void end_frame_rendering(VkCommandBuffer cmd_buffer, const frame_target& target)
+{
+    if(target.rendering == nullptr)
+    {
+        vkCmdEndRenderPass(cmd_buffer);
+        return;
+    }
+    vkCmdEndRenderingKHR(cmd_buffer);
+    transition_target_image(cmd_buffer, *target.rendering, true);
+}
+
+//draws into whatever the command buffer is rendering to, within viewport and scissor
+void record_vertices(VkCommandBuffer cmd_buffer, const VkViewport& viewport, const VkRect2D& scissor, const render_data_t& render_data,
+VkBuffer vertices)
+{
+    //still compiling and no fallback, the pass only clears this frame
+    VkPipeline pipeline = render_data.graphics_pipeline.get();
+    if(render_data.shader_objects.has_value())
+        render_data.shader_objects->bind(cmd_buffer, viewport, scissor);
+    else if(pipeline != VK_NULL_HANDLE)
+    {
+        vkCmdBindPipeline(cmd_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+        render_data.draw_state.record(cmd_buffer, render_data.dynamic_states);
+        vkCmdSetViewport(cmd_buffer, 0, 1, &viewport);
+        vkCmdSetScissor(cmd_buffer, 0, 1, &scissor);
+    }
+    if(render_data.shader_objects.has_value() || pipeline != VK_NULL_HANDLE)
+    {
+        VkDeviceSize offset{0};
+        vkCmdBindVertexBuffers(cmd_buffer, 0, 1, &vertices, &offset);
+        vkCmdBindIndexBuffer(cmd_buffer, render_data.index_buffer, 0, VK_INDEX_TYPE_UINT32);
+
+        vkCmdDrawIndexed(cmd_buffer, INDICES.size(), 1, 0, 0, 0);
+    }
+}
+void record_triangles(VkCommandBuffer cmd_buffer, const VkViewport& viewport, const VkRect2D& scissor, const render_data_t& render_data)
+{
+    record_vertices(cmd_buffer, viewport, scissor, render_data, render_data.vertex_buffer);
+}
+//submits a recorded frame command buffer on the render queue, with the semaphores render callbacks get
+bool submit_frame_commands(VkCommandBuffer cmd_buffer, VkSemaphore signal_semaphore, VkFence signal_fence, const VkSemaphore image_available,
+const render_data_t& render_data, const bool throws = true)
+{
+    VkSubmitInfo submit_info{};
+    submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submit_info.commandBufferCount = 1, submit_info.pCommandBuffers = &cmd_buffer;
+    
+    //headless frames have no image to wait for and nothing to present, their semaphores are VK_NULL_HANDLE
+    std::array<VkSemaphore, 2> wait_s{};
+    std::array<VkPipelineStageFlags, 2> wait_stage_mask{};
+    submit_info.waitSemaphoreCount = 0;
+    if(image_available != VK_NULL_HANDLE)
+    {
+        wait_s[0] = image_available, wait_stage_mask[0] = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+        submit_info.waitSemaphoreCount = 1;
+    }
+    if(render_data.async_compute != nullptr)
+    {
+        VkSemaphore compute_finished = render_data.async_compute->take_wait_semaphore();
+        if(compute_finished != VK_NULL_HANDLE)
+        {
+            wait_s[submit_info.waitSemaphoreCount] = compute_finished;
+            wait_stage_mask[submit_info.waitSemaphoreCount] = render_data.async_compute->get_consumer_stage();
+            submit_info.waitSemaphoreCount++;
+        }
+    }
+    submit_info.pWaitSemaphores = wait_s.data();
+    submit_info.pWaitDstStageMask = wait_stage_mask.data();
+
+    VkSemaphore submit_s = signal_semaphore;
+    submit_info.signalSemaphoreCount = signal_semaphore != VK_NULL_HANDLE ? 1 : 0, submit_info.pSignalSemaphores = &submit_s;
+
+    EXIT_IF(vkQueueSubmit(render_data.submit_queue, 1, &submit_info, signal_fence), "FAILED TO SUBMIT CMD BUFFER", DO_NOTHING);
+    
+    return true;
+}
 
 bool render_triangles(VkSemaphore signal_semaphore, VkFence signal_fence, const VkSemaphore image_available, 
-const VkRenderPassBeginInfo renderpass_binfo, uint frame_index, const render_data_t& render_data, const bool throws = true)
+const frame_target& target, uint frame_index, const render_data_t& render_data, const bool throws = true)
 {
     VkCommandBufferBeginInfo begin_info{};
     begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
     begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
     
     const auto& cmd_buffer = render_data.command_buffers.handle[frame_index];
+    render_data.descriptor_allocator.reset(frame_index);
 
     EXIT_IF(vkBeginCommandBuffer(cmd_buffer, &begin_info), "FAILED TO BEGIN CMD BUFFER", DO_NOTHING);
 
-    vkCmdBeginRenderPass(cmd_buffer, &renderpass_binfo, VK_SUBPASS_CONTENTS_INLINE);
-    vkCmdBindPipeline(cmd_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, render_data.graphics_pipeline.handle[0]);
-    
-    VkViewport viewport{(float)renderpass_binfo.renderArea.offset.x, (float)renderpass_binfo.renderArea.offset.y,
-    (float)renderpass_binfo.renderArea.extent.width, (float)renderpass_binfo.renderArea.extent.height, 0.0, 1.0};
-    vkCmdSetViewport(cmd_buffer, 0, 1, &viewport);
-    VkRect2D scissor{renderpass_binfo.renderArea};
-    vkCmdSetScissor(cmd_buffer, 0, 1, &scissor);
-
-    VkDeviceSize offset{0};
-    vkCmdBindVertexBuffers(cmd_buffer, 0, 1, &render_data.vertex_buffer.handle, &offset);
-    vkCmdBindIndexBuffer(cmd_buffer, render_data.index_buffer, 0, VK_INDEX_TYPE_UINT32);
+    VkBuffer vertices = render_data.vertex_buffer;
+    if(render_data.animation.has_value())
+        vertices = render_data.animation->animate(frame_index, render_data.descriptor_allocator);
 
-    vkCmdDrawIndexed(cmd_buffer, INDICES.size(), 1, 0, 0, 0);
-    vkCmdEndRenderPass(cmd_buffer);
+    begin_frame_rendering(cmd_buffer, target);
+    VkViewport viewport{(float)target.begin_info.renderArea.offset.x, (float)target.begin_info.renderArea.offset.y,
+    (float)target.begin_info.renderArea.extent.width, (float)target.begin_info.renderArea.extent.height, 0.0, 1.0};
+    record_vertices(cmd_buffer, viewport, target.begin_info.renderArea, render_data, vertices);
+    end_frame_rendering(cmd_buffer, target);
 
     EXIT_IF(vkEndCommandBuffer(cmd_buffer), "FAILED TO END CMD BUFFER", DO_NOTHING);
 
-    VkSubmitInfo submit_info{};
-    submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-    submit_info.commandBufferCount = 1, submit_info.pCommandBuffers = &cmd_buffer;
-    
-    VkSemaphore wait_s = image_available;
-    submit_info.waitSemaphoreCount = 1, submit_info.pWaitSemaphores = &wait_s;
-    VkPipelineStageFlags wait_stage_mask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-    submit_info.pWaitDstStageMask = &wait_stage_mask;
-
-    VkSemaphore submit_s = signal_semaphore;
-    submit_info.signalSemaphoreCount = 1, submit_info.pSignalSemaphores = &submit_s;
+    return submit_frame_commands(cmd_buffer, signal_semaphore, signal_fence, image_available, render_data, throws);
+}
 
-    EXIT_IF(vkQueueSubmit(render_data.submit_queue, 1, &submit_info, signal_fence), "FAILED TO SUBMIT CMD BUFFER", DO_NOTHING);
+struct frame_data_t
+{
+    struct indexed_data
+    {
+        vk::fence       f_rendering_finished;
+        vk::semaphore   swapchain_img_acquired;
+        vk::semaphore   s_rendering_finished;
+        indexed_data(const vk::device& device) :
+        f_rendering_finished(data::fence_desc{device, VK_FENCE_CREATE_SIGNALED_BIT}),
+        swapchain_img_acquired(data::semaphore_desc{device}),
+        s_rendering_finished(data::semaphore_desc{device})
+        {
+        }
+    };
+    std::vector<indexed_data> idx_data;
+    //both empty with dynamic rendering, a resize then only touches the swapchain
+    std::vector<vk::framebuffer> swapchain_framebuffers;
+    std::optional<vk::renderpass> framebuffer_renderpass;
+    std::vector<vk::shared_image_view> swapchain_views;
+    VkExtent2D target_extent;
+    VkFormat    color_format;
+    //what the targets are left in once rendered, PRESENT_SRC for swapchain images
+    VkImageLayout final_layout;
+    VkQueue present_queue;
+
+    frame_data_t(const vk::device& device, uint frames_in_flight, std::vector<vk::shared_image_view> image_views, VkExtent2D framebuffer_size,
+    VkFormat color_format, bool dynamic_rendering, VkImageLayout final_layout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR) : 
+    framebuffer_renderpass(get_frame_renderpass(device, color_format, final_layout, dynamic_rendering)), color_format(color_format),
+    final_layout(final_layout)
+    {
+        idx_data.reserve(frames_in_flight);
+        for(size_t i = 0; i < frames_in_flight; ++i)
+        {
+            idx_data.emplace_back(device);
+        }
+        update_render_targets(image_views, framebuffer_size, device);
+        present_queue = get::device::queue_handle(device, device.description.present_queue);
+    }
+    void update_render_targets(std::vector<vk::shared_image_view> image_views, VkExtent2D framebuffer_size, VkDevice device)
+    {
+        swapchain_views = image_views;
+        target_extent   = framebuffer_size;
+        swapchain_framebuffers.clear();
+        if(!framebuffer_renderpass.has_value())
+            return;
+
+        std::vector<data::framebuffer_desc> descriptions{};
+        for(auto view : image_views)
+        {
+            data::framebuffer_desc desc{};
+            desc.attachments.push_back(*view);
+            desc.height = framebuffer_size.height;
+            desc.width  = framebuffer_size.width;
+            desc.renderpass = framebuffer_renderpass.value();
+            desc.parent     = device;
+            descriptions.push_back(desc);
+        }
+        swapchain_framebuffers.reserve(descriptions.size());
+        for(auto& d : descriptions)
+            swapchain_framebuffers.emplace_back(vk::framebuffer(d));
+    }
+    std::optional<data::rendering_desc> get_rendering_desc() const
+    {
+        if(framebuffer_renderpass.has_value())
+            return std::nullopt;
+        data::rendering_desc desc{};
+        desc.color_formats = {color_format};
+        return desc;
+    }
     
-    return true;
-}
+    private:
+    frame_target get_target(uint image_index)
+    {
+        frame_target target{};
+        auto& info = target.begin_info;
+        info.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+        info.clearValueCount = 1;
+        info.pClearValues = &clr;
+        info.pNext = nullptr;
+        info.renderArea.extent = target_extent;
+        info.renderArea.offset = {0, 0};
+        if(!framebuffer_renderpass.has_value())
+        {
+            update_rendering_target(image_index, info.renderArea);
+            target.rendering = &rendering_target;
+            return target;
+        }
+        info.renderPass = framebuffer_renderpass.value();
+        info.framebuffer = swapchain_framebuffers[image_index];   //image index!! I was putting frame idnex
+        return target;
+        //TODO make sure teh swapchain -> framebuffer pipeline is properly syncchronized!
+        //I am lucky I was able to catch this error here
+    }
+    //same load and store ops as the frame renderpass
+    void update_rendering_target(uint image_index, VkRect2D area)
+    {
+        const auto& view = swapchain_views[image_index];
+        rendering_target.image = view->description.image;
+        rendering_target.final_layout = final_layout;
+
+        auto& color = rendering_target.color_attachment;
+        color = VkRenderingAttachmentInfoKHR{};
+        color.sType       = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO_KHR;
+        color.imageView   = *view;
+        color.imageLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+        color.loadOp      = VK_ATTACHMENT_LOAD_OP_CLEAR;
+        color.storeOp     = VK_ATTACHMENT_STORE_OP_STORE;
+        color.clearValue  = clr;
+
+        auto& info = rendering_target.info;
+        info = VkRenderingInfoKHR{};
+        info.sType = VK_STRUCTURE_TYPE_RENDERING_INFO_KHR;
+        info.renderArea = area;
+        info.layerCount = 1;
+        info.colorAttachmentCount = 1, info.pColorAttachments = &color;
+    }
+    dynamic_rendering_target rendering_target{};//pointed to by the target, like clr
+    VkClearValue clr{};//kept alive for renderpass begin ingo
+    friend class frame;
+    friend class headless_frame;
+    friend class multi_frame;
+    uint frame_idx = 0;
+    static std::optional<vk::renderpass> get_frame_renderpass(const vk::device& device, VkFormat format, VkImageLayout final_layout,
+    bool dynamic_rendering)
+    {
+        if(dynamic_rendering)
+            return std::nullopt;
+        return std::optional<vk::renderpass>(std::in_place, get_frame_renderpass_desc(device, format, final_layout));
+    }
+    static data::renderpass_desc get_frame_renderpass_desc(const vk::device& device, VkFormat format, VkImageLayout final_layout)
+    {
+        data::renderpass_desc desc{};
+    
+        desc.attachments.resize(1);
+        desc.attachments[0].format        = format;
+        desc.attachments[0].initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        desc.attachments[0].finalLayout   = final_layout;
+        desc.attachments[0].flags         = 0;
+        desc.attachments[0].loadOp        = VK_ATTACHMENT_LOAD_OP_CLEAR;  //beginning of the subpass
+        desc.attachments[0].storeOp       = VK_ATTACHMENT_STORE_OP_STORE; //end of the subpass
+        desc.attachments[0].samples       = VK_SAMPLE_COUNT_1_BIT;
+        desc.attachments[0].stencilLoadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+        desc.attachments[0].stencilStoreOp = VK_ATTACHMENT_STORE_OP_STORE;
+        desc.subpass_descriptions.resize(1);
+        desc.subpass_descriptions[0].bind_point = VK_PIPELINE_BIND_POINT_GRAPHICS;
+        desc.subpass_descriptions[0].color_attachment_refs.resize(1);
+        desc.subpass_descriptions[0].color_attachment_refs[0].attachment = 0; //index
+        desc.subpass_descriptions[0].color_attachment_refs[0].layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL; //layout during subpassdesc
+        desc.subpass_dependencies.resize(1);
+        desc.subpass_dependencies[0].dependencyFlags = 0;   
+        desc.subpass_dependencies[0].srcSubpass = VK_SUBPASS_EXTERNAL;
+        desc.subpass_dependencies[0].dstSubpass = 0;
+        desc.subpass_dependencies[0].srcStageMask  = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;            //wait for nothing
+        desc.subpass_dependencies[0].dstStageMask  = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;//this is where the color attachment load op and store op happens
+        desc.subpass_dependencies[0].srcAccessMask = 0; //no access flags
+        desc.subpass_dependencies[0].dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+        /*
+        If stage 5 of B depends on stage 3 of A, then we specify such depedence in the src and dst stage masks.
+        Stages 1-4 of B will be executed regardless of A, but stage 5 will wait on stage 3 of A.
+        from reddit : https://www.reddit.com/r/vulkan/comments/muo5ud/subpasses_dependencies_stage_and_access_masks/
+            Access masks relate to memory availability/visibility. Somewhat suprising (at least it was to me initially), is that just because you set up an execution dependency where for example, A (the src) writes to some resource and then B (dst) reads from the resource. Even if B executes after A, that doesn't mean B will "see" the changes A has made, because of caching! It is very possible that even though A has finished, it has made its changes to a memory cache that hasn't been made available/"flushed". So in the dependency you could use
+
+                srcAccessMask=VK_ACCESS_MEMORY_WRITE_BIT
+                dstAccessMask=VK_ACCESS_MEMORY_READ_BIT
+
+            I don't know actually know how gpu cache structures work or are organized but I think the general idea is
+
+                The src access mask says that the memory A writes to should be made available/"flushed" to like the shared gpu memory
+
+                The dst access mask says that the memory/cache B reads from should first pull from the shared gpu memory
+
+            This way B is reading from up to date memory, and not stale cache data.
+        https://themaister.net/blog/2019/08/14/yet-another-blog-explaining-vulkan-synchronization/
+            srcStageMask of TOP_OF_PIPE is basically saying “wait for nothing”, or to be more precise,
+            we’re waiting for the GPU to parse all commands, which is, a complete noop. 
+            We had to parse all commands before getting to the pipeline barrier command to begin with.
+
+            As an analog to srcStageMask with TOP_OF_PIPE, for dstStageMask, using BOTTOM_OF_PIPE can be kind of useful.
+            This basically translates to “block the last stage of execution in the pipeline”. Basically, we translate 
+            this to mean “no work after this barrier is going to wait for us”. 
+        BOTTOM OF THE PIPE is the last stage of execution, TOP OF THE PIPE is the first 
+            Memory access and TOP_OF_PIPE/BOTTOM_OF_PIPE
+
+            Never use AccessMask != 0 with these stages. These stages do not perform memory accesses,
+            so any srcAccessMask and dstAccessMask combination with either stage will be meaningless,
+            and spec disallows this. TOP_OF_PIPE and BOTTOM_OF_PIPE are purely there for the sake of execution barriers,
+            not memory barriers.
+    */
+        //images that aren't presented get read back, the copy has to wait for the store op
+        if(final_layout == VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL)
+        {
+            VkSubpassDependency readback{};
+            readback.srcSubpass    = 0;
+            readback.dstSubpass    = VK_SUBPASS_EXTERNAL;
+            readback.srcStageMask  = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+            readback.dstStageMask  = VK_PIPELINE_STAGE_TRANSFER_BIT;
+            readback.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+            readback.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+            desc.subpass_dependencies.push_back(readback);
+        }
+        desc.parent = device;
+    
+        return desc;
+    }
+    static data::cmd_pool_desc get_cmdpool_desc(const vk::device& device)
+    {
+        data::cmd_pool_desc desc{};
+        desc.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+        desc.parent = device;
+        desc.queue_fam_index = device.description.graphics_queue.fam_idx;
+        return desc;
+    }
+
+};
 
 class frame
 {
@@ -378,7 +1006,7 @@ private:
         window_t(description description, VkInstance instance, vk::shared_device owner) : 
         window_ptr(glfwCreateWindow(description.width, description.height, description.title, nullptr, nullptr)),
         surface(data::surface_desc{instance, window_ptr}), 
-        swapchain(new vk::swapchain(get::swapchain::description(surface, *owner)))
+        swapchain(new vk::swapchain(get::swapchain::description(surface, *owner, surface_support)))
         {
             this->owner = owner;
             
@@ -404,14 +1032,14 @@ private:
             return views;
         }
         
-        //framebuffers must be updated after calling this!
+        //render targets must be updated after calling this!
         bool update_swapchain()
         {
             //please don't touch this function again. please. (i did touch it again. many times ;> )
 
             vk_handle::description::swapchain_desc desc{};
 
-            auto description = get::swapchain::description(this->surface, *this->owner, *this->swapchain);
+            auto description = get::swapchain::description(this->surface, *this->owner, surface_support, *this->swapchain);
 
             auto temp = swapchain;  //old swapchain saved here
 
@@ -431,7 +1059,10 @@ private:
         
         private:
         friend class frame;
+        friend class multi_frame;
         vk::surface            surface;
+        //queried once, a resize only asks for the new capabilities
+        data::surface_support surface_support{};
         vk::shared_swapchain swapchain;
 
         std::vector<vk::shared_image_view> swapchain_image_views;
@@ -464,154 +1095,15 @@ private:
             }
         }
     };
-    struct frame_data_t
-    {
-        struct indexed_data
-        {
-            vk::fence       f_rendering_finished;
-            vk::semaphore   swapchain_img_acquired;
-            vk::semaphore   s_rendering_finished;
-            indexed_data(const vk::device& device) :
-            f_rendering_finished(data::fence_desc{device, VK_FENCE_CREATE_SIGNALED_BIT}),
-            swapchain_img_acquired(data::semaphore_desc{device}),
-            s_rendering_finished(data::semaphore_desc{device})
-            {
-            }
-        };
-        std::vector<indexed_data> idx_data;
-        std::vector<vk::framebuffer> swapchain_framebuffers;
-        vk::renderpass framebuffer_renderpass;
-        VkQueue present_queue;
-
-        frame_data_t(const vk::device& device, uint frames_in_flight, std::vector<vk::shared_image_view> image_views, VkExtent2D framebuffer_size) : 
-        framebuffer_renderpass(get_frame_renderpass_desc(device))
-        {
-            idx_data.reserve(frames_in_flight);
-            for(size_t i = 0; i < frames_in_flight; ++i)
-            {
-                idx_data.emplace_back(device);
-            }
-            update_framebuffers(image_views, framebuffer_size, device);
-            present_queue = get::device::queue_handle(device, device.description.present_queue);
-        }
-        void update_framebuffers(std::vector<vk::shared_image_view> image_views, VkExtent2D framebuffer_size, VkDevice device)
-        {
-            std::vector<data::framebuffer_desc> descriptions{};
-            for(auto view : image_views)
-            {
-                data::framebuffer_desc desc{};
-                desc.attachments.push_back(*view);
-                desc.height = framebuffer_size.height;
-                desc.width  = framebuffer_size.width;
-                desc.renderpass = framebuffer_renderpass;
-                desc.parent     = device;
-                descriptions.push_back(desc);
-            }
-            swapchain_framebuffers.clear();
-            swapchain_framebuffers.reserve(descriptions.size());
-            for(auto& d : descriptions)
-                swapchain_framebuffers.emplace_back(vk::framebuffer(d));
-        }
-        
-        private:
-        VkRenderPassBeginInfo get_begin_info(uint image_index)
-        {
-            VkRenderPassBeginInfo info{};
-            info.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-            info.clearValueCount = 1;
-            info.pClearValues = &clr;
-            info.pNext = nullptr;
-            info.renderArea.extent = VkExtent2D{swapchain_framebuffers[0].description.width, swapchain_framebuffers[0].description.height};
-            info.renderArea.offset = {0, 0};
-            info.renderPass = framebuffer_renderpass;
-            info.framebuffer = swapchain_framebuffers[image_index];   //image index!! I was putting frame idnex
-            return info;
-            //TODO make sure teh swapchain -> framebuffer pipeline is properly syncchronized!
-            //I am lucky I was able to catch this error here
-        }
-        VkClearValue clr{};//kept alive for renderpass begin ingo
-        friend class frame;
-        uint frame_idx = 0;
-        static data::renderpass_desc get_frame_renderpass_desc(const vk::device& device)
-        {
-            data::renderpass_desc desc{};
-        
-            desc.attachments.resize(1);
-            desc.attachments[0].format = get::physical_device::get_surface_features(*VULKAN, device.description.phys_device).surface_format.format;
-            desc.attachments[0].initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-            desc.attachments[0].finalLayout   = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
-            desc.attachments[0].flags         = 0;
-            desc.attachments[0].loadOp        = VK_ATTACHMENT_LOAD_OP_CLEAR;  //beginning of the subpass
-            desc.attachments[0].storeOp       = VK_ATTACHMENT_STORE_OP_STORE; //end of the subpass
-            desc.attachments[0].samples       = VK_SAMPLE_COUNT_1_BIT;
-            desc.attachments[0].stencilLoadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-            desc.attachments[0].stencilStoreOp = VK_ATTACHMENT_STORE_OP_STORE;
-            desc.subpass_descriptions.resize(1);
-            desc.subpass_descriptions[0].bind_point = VK_PIPELINE_BIND_POINT_GRAPHICS;
-            desc.subpass_descriptions[0].color_attachment_refs.resize(1);
-            desc.subpass_descriptions[0].color_attachment_refs[0].attachment = 0; //index
-            desc.subpass_descriptions[0].color_attachment_refs[0].layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL; //layout during subpassdesc
-            desc.subpass_dependencies.resize(1);
-            desc.subpass_dependencies[0].dependencyFlags = 0;   
-            desc.subpass_dependencies[0].srcSubpass = VK_SUBPASS_EXTERNAL;
-            desc.subpass_dependencies[0].dstSubpass = 0;
-            desc.subpass_dependencies[0].srcStageMask  = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;            //wait for nothing
-            desc.subpass_dependencies[0].dstStageMask  = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;//this is where the color attachment load op and store op happens
-            desc.subpass_dependencies[0].srcAccessMask = 0; //no access flags
-            desc.subpass_dependencies[0].dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
-            /*
-            If stage 5 of B depends on stage 3 of A, then we specify such depedence in the src and dst stage masks.
-            Stages 1-4 of B will be executed regardless of A, but stage 5 will wait on stage 3 of A.
-            from reddit : https://www.reddit.com/r/vulkan/comments/muo5ud/subpasses_dependencies_stage_and_access_masks/
-                Access masks relate to memory availability/visibility. Somewhat suprising (at least it was to me initially), is that just because you set up an execution dependency where for example, A (the src) writes to some resource and then B (dst) reads from the resource. Even if B executes after A, that doesn't mean B will "see" the changes A has made, because of caching! It is very possible that even though A has finished, it has made its changes to a memory cache that hasn't been made available/"flushed". So in the dependency you could use
-
-                    srcAccessMask=VK_ACCESS_MEMORY_WRITE_BIT
-                    dstAccessMask=VK_ACCESS_MEMORY_READ_BIT
-
-                I don't know actually know how gpu cache structures work or are organized but I think the general idea is
-
-                    The src access mask says that the memory A writes to should be made available/"flushed" to like the shared gpu memory
-
-                    The dst access mask says that the memory/cache B reads from should first pull from the shared gpu memory
-
-                This way B is reading from up to date memory, and not stale cache data.
-            https://themaister.net/blog/2019/08/14/yet-another-blog-explaining-vulkan-synchronization/
-                srcStageMask of TOP_OF_PIPE is basically saying “wait for nothing”, or to be more precise,
-                we’re waiting for the GPU to parse all commands, which is, a complete noop. 
-                We had to parse all commands before getting to the pipeline barrier command to begin with.
-
-                As an analog to srcStageMask with TOP_OF_PIPE, for dstStageMask, using BOTTOM_OF_PIPE can be kind of useful.
-                This basically translates to “block the last stage of execution in the pipeline”. Basically, we translate 
-                this to mean “no work after this barrier is going to wait for us”. 
-            BOTTOM OF THE PIPE is the last stage of execution, TOP OF THE PIPE is the first 
-                Memory access and TOP_OF_PIPE/BOTTOM_OF_PIPE
-
-                Never use AccessMask != 0 with these stages. These stages do not perform memory accesses,
-                so any srcAccessMask and dstAccessMask combination with either stage will be meaningless,
-                and spec disallows this. TOP_OF_PIPE and BOTTOM_OF_PIPE are purely there for the sake of execution barriers,
-                not memory barriers.
-        */
-            desc.parent = device;
-        
-            return desc;
-        }
-        static data::cmd_pool_desc get_cmdpool_desc(const vk::device& device)
-        {
-            data::cmd_pool_desc desc{};
-            desc.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
-            desc.parent = device;
-            desc.queue_fam_index = device.description.graphics_queue.fam_idx;
-            return desc;
-        }
-
-    };
     window_t window;
     frame_data_t data;
 public:
     
-    frame(int width, int height, const char* title, uint frames_in_flight, vk::shared_device device) :
+    //dynamic rendering is only used if the device supports it
+    frame(int width, int height, const char* title, uint frames_in_flight, vk::shared_device device, bool dynamic_rendering = true) :
     window({width, height, title}, *VULKAN, device), 
-    data(*device, frames_in_flight, window_t::get_window_image_views(window), window.get_framebuffer_size())
+    data(*device, frames_in_flight, window_t::get_window_image_views(window), window.get_framebuffer_size(),
+    window.get_features().surface_format.format, dynamic_rendering && device->description.dynamic_rendering_features.has_value())
     {
         glfwSetWindowUserPointer(window.window_ptr, this);
         glfwSetFramebufferSizeCallback(window.window_ptr, window_resize_callback);   
@@ -622,22 +1114,33 @@ public:
         return internal_draw_frames(data, data.idx_data.size(), render_callback, render_data);
     }
 
+    //VK_NULL_HANDLE with dynamic rendering, pipelines take get_rendering_desc() instead
     VkRenderPass get_renderpass()
     {
-        return data.framebuffer_renderpass;
+        if(!data.framebuffer_renderpass.has_value())
+            return VK_NULL_HANDLE;
+        return data.framebuffer_renderpass.value();
+    }
+    std::optional<data::rendering_desc> get_rendering_desc() const
+    {
+        return data.get_rendering_desc();
     }
     GLFWwindow* get_window_handle()
     {
         return window.window_ptr;
     }
+    //signalled once the last draw_frames() call's frame is rendered, VK_NULL_HANDLE if it submitted nothing
+    VkFence get_submitted_fence() const {return submitted_fence;}
 private:
+    friend class multi_frame;
     void update_frame()
     {
         window.update_swapchain();
-        data.update_framebuffers(window_t::get_window_image_views(window), window.get_framebuffer_size(), *window.owner);
+        data.update_render_targets(window_t::get_window_image_views(window), window.get_framebuffer_size(), *window.owner);
         frame_resized = false;
     }
     bool frame_resized = false;
+    VkFence submitted_fence = VK_NULL_HANDLE;
     static void window_resize_callback(GLFWwindow* window, [[maybe_unused]] int width, [[maybe_unused]] int height)
     {
         auto ptr = glfwGetWindowUserPointer(window);
@@ -649,6 +1152,7 @@ private:
     {
         data.frame_idx = (data.frame_idx + 1)%max_frames_inflight;
         auto& idx_data = data.idx_data[data.frame_idx];
+        submitted_fence = VK_NULL_HANDLE;
 
 
         auto& device_handle = *window.owner;
@@ -671,8 +1175,9 @@ private:
         vkResetFences(device_handle, 1, &frame_rendered);
 
         
-        render_callback(idx_data.s_rendering_finished, idx_data.f_rendering_finished, idx_data.swapchain_img_acquired, 
-        data.get_begin_info(swpch_img_idx), data.frame_idx, render_data, throws);
+        if(render_callback(idx_data.s_rendering_finished, idx_data.f_rendering_finished, idx_data.swapchain_img_acquired, 
+        data.get_target(swpch_img_idx), data.frame_idx, render_data, throws))
+            submitted_fence = frame_rendered;
 
         VkPresentInfoKHR swpch_present_info{};
         swpch_present_info.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
@@ -685,91 +1190,1092 @@ private:
         return true;
     }
 };
-//TODO frame should know hot to render itself. Perhaps add an interface to influence its graphics pipeline,
-//but it should have ownership of a little renderpass and command buffers that render it. 
-//In addition with the frame sending its own command buffer to the render function, this would eliminate the need for explicit synchronization.
-
+/*
+    Several windows on one device, drawn as one frame : every swapchain is acquired first, the render callback records
+    and submits once per window, and a single vkQueuePresentKHR presents all of them. The windows share one fence per
+    frame in flight, signalled by the last window's submission, so the loop waits once no matter how many windows there are.
 
-//remember, this is a thin vulkan abstraction :>
-int main([[maybe_unused]] int argc, [[maybe_unused]] char* argv[])
+    The callback's frame index is frame * window count + window, render_data needs get_command_buffer_count() buffers.
+    Pipelines are built for the first window's target, the others must have the same surface format.
+*/
+class multi_frame
 {
-    vulkan_context context;
-    context.start();    //this will enforce correct destruction order
-    
-    vk::shared_device device(std::make_shared<vk::device>(get::device::description(*VULKAN, 
-    get::physical_device::pick_best_physical_device(PHYSICAL_DEVICES))));
-
-    auto funcs = get::vma_functions();
-    vk::allocator allocator (VmaAllocatorCreateInfo{
-        .physicalDevice   = device->description.phys_device,
-        .device           = *device,
-        .pVulkanFunctions = &funcs,
-        .instance         = *VULKAN
-    });
-
-    constexpr uint FRAMES_IN_FLIGHT = 2;
+public:
+    struct window_desc
+    {
+        int width, height;
+        const char* title;
+    };
 
-    frame my_frame(150, 150, "title", FRAMES_IN_FLIGHT, device);
-    
-    vk::buffer vertex_buffer(data::buffer_desc
+    multi_frame(const std::vector<window_desc>& descriptions, uint frames_in_flight, vk::shared_device device, bool dynamic_rendering = true) :
+    frames_in_flight(frames_in_flight)
     {
-        .parent    = *device,
-        .allocator = allocator,
-        .alloc_info = VmaAllocationCreateInfo
+        dynamic_rendering = dynamic_rendering && device->description.dynamic_rendering_features.has_value();
+        windows.reserve(descriptions.size());
+        for(const auto& desc : descriptions)
         {
-            .usage = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE,
-            .requiredFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-            .pool = VK_NULL_HANDLE
-        },
-        .size = sizeof(vertex) * TRIANGLE_VERTICES.size(),
-        .usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-        .queue_fam_indices = {device->description.graphics_queue.fam_idx}
-    });
-    vk::buffer index_buffer(data::buffer_desc
+            auto entry = std::make_unique<window_entry>(desc, frames_in_flight, device, dynamic_rendering);
+            glfwSetWindowUserPointer(entry->window.window_ptr, entry.get());
+            glfwSetFramebufferSizeCallback(entry->window.window_ptr, window_resize_callback);
+            if(!windows.empty() && entry->data.color_format != windows.front()->data.color_format)
+                INFORM_ERR("WARNING : window " << desc.title << " has a different surface format than the first window");
+            windows.push_back(std::move(entry));
+        }
+    }
+
+    bool draw_frames(frame_render_callback_fnc render_callback, const render_data_t& render_data, const bool throws = true)
     {
-        .parent    = *device,
-        .allocator = allocator,
-        .alloc_info = VmaAllocationCreateInfo
+        frame_idx = (frame_idx + 1)%frames_in_flight;
+        submitted_fence = VK_NULL_HANDLE;
+        VkDevice device_handle = *windows.front()->window.owner;
+        VkFence frame_rendered = windows.front()->data.idx_data[frame_idx].f_rendering_finished;
+        vkWaitForFences(device_handle, 1, &frame_rendered, VK_TRUE, UINT64_MAX);
+
+        std::vector<uint32_t>          acquired;    //window index
+        std::vector<uint32_t>     image_indices;
+        std::vector<VkSwapchainKHR>  swapchains;
+        std::vector<VkSemaphore>       rendered;
+        for(uint32_t i = 0; i < windows.size(); ++i)
         {
-            .usage = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE,
-            .requiredFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-            .pool = VK_NULL_HANDLE
-        },
-        .size = sizeof(uint32_t) * INDICES.size(),
-        .usage = VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-        .queue_fam_indices = {device->description.graphics_queue.fam_idx}
-    });
-    vk::buffer staging_buffer(data::buffer_desc
-    {
-        .parent    = *device,
-        .allocator = allocator,
-        .alloc_info = VmaAllocationCreateInfo
+            auto& entry = *windows[i];
+            if(entry.resized)
+                entry.update();
+            auto& idx_data = entry.data.idx_data[frame_idx];
+            uint32_t image_index;
+            auto result = vkAcquireNextImageKHR(device_handle, *entry.window.swapchain, UINT64_MAX, idx_data.swapchain_img_acquired,
+            VK_NULL_HANDLE, &image_index);
+            //the semaphore is untouched on failure, skip the window for this frame
+            if(result == VK_ERROR_OUT_OF_DATE_KHR)
+            {
+                entry.resized = true;
+                continue;
+            }
+            EXIT_IF(result < 0, "FAILED TO ACQUIRE NEXT SWAPCHAIN IMAGE", DO_NOTHING)
+            acquired.push_back(i), image_indices.push_back(image_index);
+            swapchains.push_back(*entry.window.swapchain), rendered.push_back(idx_data.s_rendering_finished);
+        }
+        if(acquired.empty())
+            return true;
+
+        vkResetFences(device_handle, 1, &frame_rendered);
+        for(size_t i = 0; i < acquired.size(); ++i)
         {
-            .flags = VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT,
-            .usage = VMA_MEMORY_USAGE_AUTO_PREFER_HOST,
-            .requiredFlags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT,
-            .pool = VK_NULL_HANDLE
-        },
-        .size = vertex_buffer.description.size + index_buffer.description.size,
-        .usage =  VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-        .queue_fam_indices = {device->description.transfer_queue.fam_idx}
-    });
-    
-    void* ptr;
-    vmaMapMemory(staging_buffer.description.allocator, staging_buffer.description.allocation_object, &ptr);
-    memcpy(ptr, TRIANGLE_VERTICES.data(), vertex_buffer.description.size);
-    memcpy(ptr + vertex_buffer.description.size, INDICES.data(), index_buffer.description.size);
-    vmaUnmapMemory(staging_buffer.description.allocator, staging_buffer.description.allocation_object);
+            auto& entry = *windows[acquired[i]];
+            auto& idx_data = entry.data.idx_data[frame_idx];
+            //the fence goes with the last submission, the queue finishes the others before it
+            VkFence fence = i + 1 == acquired.size() ? frame_rendered : VK_NULL_HANDLE;
+            render_callback(idx_data.s_rendering_finished, fence, idx_data.swapchain_img_acquired, entry.data.get_target(image_indices[i]),
+            frame_idx * windows.size() + acquired[i], render_data, throws);
+        }
+        submitted_fence = frame_rendered;
+
+        std::vector<VkResult> results(swapchains.size());
+        VkPresentInfoKHR present_info{};
+        present_info.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
+        present_info.waitSemaphoreCount = static_cast<uint32_t>(rendered.size()), present_info.pWaitSemaphores = rendered.data();
+        present_info.swapchainCount = static_cast<uint32_t>(swapchains.size()), present_info.pSwapchains = swapchains.data();
+        present_info.pImageIndices = image_indices.data(), present_info.pResults = results.data();
+        vkQueuePresentKHR(windows.front()->data.present_queue, &present_info);
+        for(size_t i = 0; i < results.size(); ++i)
+        {
+            if(results[i] == VK_ERROR_OUT_OF_DATE_KHR || results[i] == VK_SUBOPTIMAL_KHR)
+                windows[acquired[i]]->resized = true;
+            else
+                EXIT_IF(results[i] < 0, "FRAME SUBMIT FAILED", DO_NOTHING);
+        }
+        return true;
+    }
 
-    vk::cmd_pool staging_pool(data::cmd_pool_desc
+    //VK_NULL_HANDLE with dynamic rendering, pipelines take get_rendering_desc() instead
+    VkRenderPass get_renderpass()
     {
-        .parent = *device,
-        .queue_fam_index = device->description.transfer_queue.fam_idx,
-        .flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT
-    });
+        auto& data = windows.front()->data;
+        if(!data.framebuffer_renderpass.has_value())
+            return VK_NULL_HANDLE;
+        return data.framebuffer_renderpass.value();
+    }
+    std::optional<data::rendering_desc> get_rendering_desc() const
+    {
+        return windows.front()->data.get_rendering_desc();
+    }
+    uint get_command_buffer_count() const {return frames_in_flight * windows.size();}
+    size_t get_window_count() const {return windows.size();}
+    //see frame::get_submitted_fence
+    VkFence get_submitted_fence() const {return submitted_fence;}
+    GLFWwindow* get_window_handle(size_t window)
+    {
+        return windows[window]->window.window_ptr;
+    }
+
+private:
+    struct window_entry
+    {
+        frame::window_t window;
+        frame_data_t      data;
+        bool      resized = false;
+
+        window_entry(const window_desc& desc, uint frames_in_flight, vk::shared_device device, bool dynamic_rendering) :
+        window({desc.width, desc.height, desc.title}, *VULKAN, device),
+        data(*device, frames_in_flight, frame::window_t::get_window_image_views(window), window.get_framebuffer_size(),
+        window.get_features().surface_format.format, dynamic_rendering)
+        {
+        }
+        void update()
+        {
+            window.update_swapchain();
+            data.update_render_targets(frame::window_t::get_window_image_views(window), window.get_framebuffer_size(), *window.owner);
+            resized = false;
+        }
+    };
+    static void window_resize_callback(GLFWwindow* window, [[maybe_unused]] int width, [[maybe_unused]] int height)
+    {
+        auto ptr = glfwGetWindowUserPointer(window);
+        reinterpret_cast<window_entry*>(ptr)->resized = true;
+    }
+
+    //entries are pointed to by their glfw window, they must not move
+    std::vector<std::unique_ptr<window_entry>> windows;
+    uint                              frames_in_flight;
+    uint                                 frame_idx = 0;
+    VkFence                submitted_fence = VK_NULL_HANDLE;
+};
+/*
+    Stands in for frame where there is no display : renders into VMA images instead of a swapchain, with the same
+    render callbacks. There is no acquire and no present, the callback gets VK_NULL_HANDLE for both semaphores.
+
+    One image per frame in flight. Once a frame's fence signals, its image is in TRANSFER_SRC_OPTIMAL and can be read back.
+    With a readback ring set, every frame is read back : when the ring is full, drawing waits for its oldest copy
+    instead of dropping the frame.
+*/
+class headless_frame
+{
+public:
+    static constexpr VkFormat DEFAULT_FORMAT = VK_FORMAT_R8G8B8A8_UNORM;
+
+    headless_frame(uint width, uint height, uint frames_in_flight, vk::shared_device device, VmaAllocator allocator,
+    bool dynamic_rendering = true, VkFormat format = DEFAULT_FORMAT) : 
+    owner(device), images(get_images(width, height, frames_in_flight, *device, allocator, format)),
+    data(*device, frames_in_flight, get_image_views(images, *device), VkExtent2D{width, height}, format,
+    dynamic_rendering && device->description.dynamic_rendering_features.has_value(), VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL),
+    texel_bytes(texel_size(format))
+    {
+    }
+
+    bool draw_frames(frame_render_callback_fnc render_callback, const render_data_t& render_data, const bool throws = true)
+    {
+        data.frame_idx = (data.frame_idx + 1)%data.idx_data.size();
+        auto& idx_data = data.idx_data[data.frame_idx];
+
+        VkFence frame_rendered = idx_data.f_rendering_finished;
+        vkWaitForFences(*owner, 1, &frame_rendered, VK_TRUE, UINT64_MAX);
+        vkResetFences(*owner, 1, &frame_rendered);
+
+        //a frame that never got submitted must still signal its fence, or the next wait on it never returns
+        auto signal_unsubmitted = [&](){vkQueueSubmit(render_data.submit_queue, 0, nullptr, frame_rendered);};
+
+        //the image index is the frame index, nothing else is using it once the fence signaled
+        bool result = false;
+        try
+        {
+            result = render_callback(VK_NULL_HANDLE, frame_rendered, VK_NULL_HANDLE, data.get_target(data.frame_idx), data.frame_idx,
+            render_data, throws);
+        }
+        catch(...)
+        {
+            signal_unsubmitted();
+            throw;
+        }
+        if(!result)
+            signal_unsubmitted();
+        submitted_fence = result ? frame_rendered : VK_NULL_HANDLE;
+        frames_drawn++;
+        //queued behind the frame on the same queue, the image is already in TRANSFER_SRC
+        if(result && readback != nullptr)
+        {
+            //a frame is only ever late, never lost
+            readback->wait_for_slot();
+            readback->read_image(images[data.frame_idx], VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, data.target_extent, on_readback, texel_bytes,
+            throws);
+            readback->poll();
+        }
+        return result;
+    }
+    //every frame drawn after this is copied into the ring and handed to callback once it's on the host. nullptr stops it
+    void set_readback(readback_ring_t* ring, readback_ring_t::callback_fnc callback)
+    {
+        if(ring != nullptr && texel_bytes == 0)
+            THROW("headless frames of this format can't be read back");
+        if(ring != nullptr && ring->get_slot_size() < VkDeviceSize(data.target_extent.width) * data.target_extent.height * texel_bytes)
+            THROW("readback slots are too small for a headless frame");
+        readback = ring, on_readback = std::move(callback);
+    }
+
+    VkRenderPass get_renderpass()
+    {
+        if(!data.framebuffer_renderpass.has_value())
+            return VK_NULL_HANDLE;
+        return data.framebuffer_renderpass.value();
+    }
+    std::optional<data::rendering_desc> get_rendering_desc() const
+    {
+        return data.get_rendering_desc();
+    }
+    //what the last draw_frames() rendered into
+    VkImage get_last_image() const {return images[data.frame_idx];}
+    uint64_t get_frames_drawn() const {return frames_drawn;}
+    //see frame::get_submitted_fence
+    VkFence get_submitted_fence() const {return submitted_fence;}
+
+private:
+    static std::vector<vk::image> get_images(uint width, uint height, uint count, const vk::device& device, VmaAllocator allocator,
+    VkFormat format)
+    {
+        std::vector<vk::image> images;
+        images.reserve(count);
+        for(uint i = 0; i < count; ++i)
+        {
+            data::image_desc desc{};
+            desc.parent    = device;
+            desc.allocator = allocator;
+            desc.alloc_info.usage = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE;
+            desc.format = format;
+            desc.extent = VkExtent3D{width, height, 1};
+            desc.usage  = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+            desc.queue_fam_indices = {device.description.graphics_queue.fam_idx};
+            images.emplace_back(desc);
+        }
+        return images;
+    }
+    static std::vector<vk::shared_image_view> get_image_views(const std::vector<vk::image>& images, VkDevice device)
+    {
+        std::vector<vk::shared_image_view> views;
+        views.reserve(images.size());
+        for(const auto& image : images)
+        {
+            data::image_view_desc desc{};
+            desc.format = image.description.format;
+            desc.image  = image;
+            desc.parent = device;
+            views.emplace_back(std::make_shared<vk::image_view>(desc));
+        }
+        return views;
+    }
+
+    vk::shared_device         owner;
+    std::vector<vk::image>   images;
+    frame_data_t               data;
+    uint64_t         frames_drawn = 0;
+    uint32_t              texel_bytes;
+    VkFence submitted_fence = VK_NULL_HANDLE;
+
+    readback_ring_t*      readback = nullptr;
+    readback_ring_t::callback_fnc on_readback;
+};
+
+/*
+    Renders many small independent jobs per submit. Each job gets a region of a large offscreen atlas and draws with
+    its own viewport and scissor; a batch is recorded into one command buffer, submitted once, read back once and split :
+
+        batch_renderer batch(1024, 1024, FRAMES_IN_FLIGHT, device, allocator, readback);
+        render_data_t render_data(*device, batch.get_renderpass(), batch.get_rendering_desc(), FRAMES_IN_FLIGHT, ...);
+        while(!batch.add({64, 64}, record_triangles, on_thumbnail))
+            batch.submit(render_data);
+        ...
+        batch.submit(render_data);
+        readback.flush();
+
+    Results come through the readback ring, so they arrive on a later poll(). The ring's slots must hold a whole atlas.
+    Regions are packed into shelves (rows as tall as their tallest job), which wastes little for jobs of similar size.
+*/
+class batch_renderer
+{
+public:
+    typedef std::function<void (VkCommandBuffer, const VkViewport&, const VkRect2D&, const render_data_t&)> job_record_fnc;
+    //pixels points at the job's top left texel, rows are row_pitch bytes apart
+    typedef std::function<void (const void* pixels, VkExtent2D extent, uint32_t row_pitch)> job_result_fnc;
+
+    batch_renderer(uint width, uint height, uint batches_in_flight, vk::shared_device device, VmaAllocator allocator,
+    readback_ring_t& readback, bool dynamic_rendering = true) :
+    target(width, height, batches_in_flight, device, allocator, dynamic_rendering), readback(readback), atlas_extent{width, height}
+    {
+    }
+
+    //false when the job doesn't fit in what's left of the atlas, submit() and add it again
+    bool add(VkExtent2D extent, job_record_fnc record, job_result_fnc on_result)
+    {
+        if(extent.width > atlas_extent.width || extent.height > atlas_extent.height)
+        {
+            INFORM_ERR("WARNING : batch job of " << extent.width << "x" << extent.height << " is larger than the atlas");
+            return false;
+        }
+        if(shelf_x + extent.width > atlas_extent.width)
+            shelf_y += shelf_height, shelf_x = 0, shelf_height = 0;
+        if(shelf_y + extent.height > atlas_extent.height)
+            return false;
+
+        VkRect2D region{{static_cast<int32_t>(shelf_x), static_cast<int32_t>(shelf_y)}, extent};
+        jobs.push_back(job{region, std::move(record), std::move(on_result)});
+        shelf_x += extent.width;
+        shelf_height = std::max(shelf_height, extent.height);
+        return true;
+    }
+
+    //records every added job into one command buffer and submits it. Only blocks if the readback ring is full
+    bool submit(const render_data_t& render_data, const bool throws = true)
+    {
+        if(jobs.empty())
+            return true;
+        auto batch = std::make_shared<std::vector<job>>(std::move(jobs));
+        VkExtent2D used{atlas_extent.width, shelf_y + shelf_height};
+        jobs.clear();
+        shelf_x = shelf_y = shelf_height = 0;
+
+        bool result = target.draw_frames([batch](VkSemaphore signal_semaphore, VkFence signal_fence, const VkSemaphore image_available,
+        const frame_target& render_target, uint frame_index, const render_data_t& render_data, const bool throws) -> bool
+        {
+            VkCommandBufferBeginInfo begin_info{};
+            begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+            begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+            const auto& cmd_buffer = render_data.command_buffers.handle[frame_index];
+            render_data.descriptor_allocator.reset(frame_index);
+            EXIT_IF(vkBeginCommandBuffer(cmd_buffer, &begin_info), "FAILED TO BEGIN BATCH CMD BUFFER", DO_NOTHING);
+
+            //one clear for the whole atlas, then every job only touches its own region
+            begin_frame_rendering(cmd_buffer, render_target);
+            for(const auto& job : *batch)
+            {
+                VkViewport viewport{(float)job.region.offset.x, (float)job.region.offset.y, (float)job.region.extent.width,
+                (float)job.region.extent.height, 0.0, 1.0};
+                job.record(cmd_buffer, viewport, job.region, render_data);
+            }
+            end_frame_rendering(cmd_buffer, render_target);
+
+            EXIT_IF(vkEndCommandBuffer(cmd_buffer), "FAILED TO END BATCH CMD BUFFER", DO_NOTHING);
+            return submit_frame_commands(cmd_buffer, signal_semaphore, signal_fence, image_available, render_data, throws);
+        }, render_data, throws);
+        if(!result)
+            return false;
+
+        //a dropped readback would lose the whole batch, waiting is the lesser evil here
+        readback.wait_for_slot();
+        uint32_t row_pitch = atlas_extent.width * TEXEL_SIZE;
+        return readback.read_image(target.get_last_image(), VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, used,
+        [batch, row_pitch](const void* pixels, VkDeviceSize)
+        {
+            for(const auto& job : *batch)
+            {
+                const char* first = static_cast<const char*>(pixels) + size_t(job.region.offset.y) * row_pitch
+                + size_t(job.region.offset.x) * TEXEL_SIZE;
+                job.on_result(first, job.region.extent, row_pitch);
+            }
+        }, TEXEL_SIZE, throws);
+    }
+
+    VkRenderPass get_renderpass() {return target.get_renderpass();}
+    std::optional<data::rendering_desc> get_rendering_desc() const {return target.get_rendering_desc();}
+    size_t get_pending_jobs() const {return jobs.size();}
+
+private:
+    static constexpr uint32_t TEXEL_SIZE = texel_size(headless_frame::DEFAULT_FORMAT);
+    struct job
+    {
+        VkRect2D          region;
+        job_record_fnc    record;
+        job_result_fnc on_result;
+    };
+
+    headless_frame           target;
+    readback_ring_t&       readback;
+    VkExtent2D         atlas_extent;
+
+    std::vector<job>           jobs;
+    uint32_t            shelf_x = 0;
+    uint32_t            shelf_y = 0;
+    uint32_t       shelf_height = 0;
+};
+
+//TODO frame should know hot to render itself. Perhaps add an interface to influence its graphics pipeline,
+//but it should have ownership of a little renderpass and command buffers that render it. 
+//In addition with the frame sending its own command buffer to the render function, this would eliminate the need for explicit synchronization.
+
+
+//remember, this is a thin vulkan abstraction :>
+//renders without a window : --headless [frame count], --capture reads every headless frame back,
+//--batch [job count] renders small jobs into an atlas instead of frames, --windows [count] opens several windows,
+//--timings reports how long each startup stage took, --animate spins the triangle on the compute queue,
+//--bench <name> runs one of the headless benchmarks for --headless [frame count] frames
+struct launch_options
+{
+    std::string    bench;
+    bool        headless = false;
+    bool         animate = false;
+    bool         timings = false;
+    bool         capture = false;
+    bool           batch = false;
+    bool           probe = false;
+    uint headless_frames = 1000;
+    uint      batch_jobs = 10000;
+    uint    window_count = 1;
+    get::device::feature_profile features = DEBUG_MODE ? get::device::DEBUG_ROBUST : get::device::RELEASE;
+    launch_options(int argc, char* argv[])
+    {
+        for(int i = 1; i < argc; ++i)
+        {
+            if(std::strcmp(argv[i], "--features") == 0 && i + 1 < argc)
+            {
+                const char* profile = argv[++i];
+                if(std::strcmp(profile, "minimal") == 0)
+                    features = get::device::MINIMAL;
+                else if(std::strcmp(profile, "robust") == 0)
+                    features = get::device::DEBUG_ROBUST;
+                else
+                    features = get::device::RELEASE;
+            }
+            if(std::strcmp(argv[i], "--capture") == 0)
+                capture = true;
+            if(std::strcmp(argv[i], "--timings") == 0)
+                timings = true;
+            if(std::strcmp(argv[i], "--probe") == 0)
+                probe = true;
+            if(std::strcmp(argv[i], "--animate") == 0)
+                animate = true;
+            if(std::strcmp(argv[i], "--bench") == 0 && i + 1 < argc)
+                headless = true, bench = argv[++i];
+            if(std::strcmp(argv[i], "--windows") == 0 && i + 1 < argc)
+                window_count = std::max(1u, static_cast<uint>(std::strtoul(argv[++i], nullptr, 10)));
+            if(std::strcmp(argv[i], "--batch") == 0)
+            {
+                headless = batch = true;
+                if(i + 1 < argc && std::isdigit(static_cast<unsigned char>(argv[i + 1][0])))
+                    batch_jobs = static_cast<uint>(std::strtoul(argv[++i], nullptr, 10));
+            }
+            if(std::strcmp(argv[i], "--headless") != 0)
+                continue;
+            headless = true;
+            if(i + 1 < argc && std::isdigit(static_cast<unsigned char>(argv[i + 1][0])))
+                headless_frames = static_cast<uint>(std::strtoul(argv[++i], nullptr, 10));
+        }
+    }
+};
+
+//the pipeline compiles in the background, only time frames that actually draw
+//frame_drawn, if given, gets every frame's fence right after it's submitted
+void run_headless(headless_frame& target, render_data_t& render_data, uint frame_count, VkDevice device,
+std::function<void (VkFence)> frame_drawn = nullptr)
+{
+    while(!render_data.shader_objects.has_value() && render_data.graphics_pipeline.get_status() == async_pipeline_t::PENDING)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+    auto start = std::chrono::steady_clock::now();
+    for(uint i = 0; i < frame_count; ++i)
+    {
+        target.draw_frames(render_triangles, render_data);
+        if(frame_drawn)
+            frame_drawn(target.get_submitted_fence());
+    }
+    vkDeviceWaitIdle(device);
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    INFORM("headless : " << frame_count << " frames in " << elapsed.count() << "s, " << frame_count / elapsed.count() << " fps");
+}
+
+void run_batch(batch_renderer& batch, render_data_t& render_data, readback_ring_t& readback, uint job_count, VkDevice device)
+{
+    while(!render_data.shader_objects.has_value() && render_data.graphics_pipeline.get_status() == async_pipeline_t::PENDING)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+    constexpr VkExtent2D JOB_EXTENT{64, 64};
+    uint64_t results = 0;
+    auto on_result = [&results](const void*, VkExtent2D, uint32_t){results++;};
+
+    auto start = std::chrono::steady_clock::now();
+    for(uint i = 0; i < job_count; ++i)
+    {
+        if(batch.add(JOB_EXTENT, record_triangles, on_result))
+            continue;
+        batch.submit(render_data);
+        batch.add(JOB_EXTENT, record_triangles, on_result);
+    }
+    batch.submit(render_data);
+    vkDeviceWaitIdle(device);
+    readback.flush();
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    INFORM("batch : " << results << " jobs in " << elapsed.count() << "s, " << results / elapsed.count() << " jobs/s");
+}
+
+/*
+    Benchmarks, --bench <name> : the triangle's draws in a few variants, timed on a headless target.
+    Each reports host time per frame (recording and submitting) and wall time per frame, which includes the GPU.
+*/
+struct bench_times
+{
+    double host_ms;
+    double wall_ms;
+};
+//record draws into a frame that's already rendering, viewport and scissor are set and passed along for shader objects
+//frame_ms, if given, gets how long each frame's draw_frames() call took
+template<typename record_fnc> bench_times time_frames(headless_frame& target, render_data_t& render_data, uint frame_count,
+VkDevice device, record_fnc record, std::vector<double>* frame_ms = nullptr)
+{
+    std::chrono::steady_clock::duration host{};
+    auto callback = [&](VkSemaphore signal_semaphore, VkFence signal_fence, const VkSemaphore image_available,
+    const frame_target& render_target, uint frame_index, const render_data_t& render_data, const bool throws) -> bool
+    {
+        auto start = std::chrono::steady_clock::now();
+        VkCommandBufferBeginInfo begin_info{};
+        begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+        const auto& cmd_buffer = render_data.command_buffers.handle[frame_index];
+        render_data.descriptor_allocator.reset(frame_index);
+        EXIT_IF(vkBeginCommandBuffer(cmd_buffer, &begin_info), "FAILED TO BEGIN BENCH CMD BUFFER", DO_NOTHING);
+
+        begin_frame_rendering(cmd_buffer, render_target);
+        const VkRect2D& area = render_target.begin_info.renderArea;
+        VkViewport viewport{0.0f, 0.0f, (float)area.extent.width, (float)area.extent.height, 0.0, 1.0};
+        vkCmdSetViewport(cmd_buffer, 0, 1, &viewport);
+        vkCmdSetScissor(cmd_buffer, 0, 1, &area);
+        record(cmd_buffer, frame_index, viewport, area);
+        end_frame_rendering(cmd_buffer, render_target);
+
+        EXIT_IF(vkEndCommandBuffer(cmd_buffer), "FAILED TO END BENCH CMD BUFFER", DO_NOTHING);
+        bool result = submit_frame_commands(cmd_buffer, signal_semaphore, signal_fence, image_available, render_data, throws);
+        host += std::chrono::steady_clock::now() - start;
+        return result;
+    };
+    vkDeviceWaitIdle(device);
+    auto start = std::chrono::steady_clock::now();
+    for(uint i = 0; i < frame_count; ++i)
+    {
+        auto frame_start = std::chrono::steady_clock::now();
+        target.draw_frames(callback, render_data);
+        std::chrono::duration<double, std::milli> frame = std::chrono::steady_clock::now() - frame_start;
+        if(frame_ms != nullptr)
+            frame_ms->push_back(frame.count());
+    }
+    vkDeviceWaitIdle(device);
+    std::chrono::duration<double, std::milli> wall = std::chrono::steady_clock::now() - start;
+    std::chrono::duration<double, std::milli> host_ms = host;
+    return bench_times{host_ms.count() / frame_count, wall.count() / frame_count};
+}
+//the triangle pipeline with another vertex shader, built for the target render_data draws into
+//push_descriptor_set picks a set layout that's pushed instead of bound, dynamic_buffer_set one bound at per draw offsets
+struct bench_pipeline_t
+{
+    vk::shader_module  vertex_shader;
+    vk::pipeline_layout       layout;
+    vk::graphics_pipeline   pipeline;
+
+    bench_pipeline_t(const vk::device& device, const embedded_shaders::entry& vertex_code, headless_frame& target, render_data_t& render_data,
+    std::optional<uint32_t> push_descriptor_set = std::nullopt, std::optional<uint32_t> dynamic_buffer_set = std::nullopt) :
+    vertex_shader(get_shader_desc(vertex_code, VK_SHADER_STAGE_VERTEX_BIT, device)),
+    layout(spirv::pipeline_layout(device, {&spirv::reflect_cached(vertex_shader.description.byte_code),
+    &spirv::reflect_cached(render_data.fragment_shader.description.byte_code)}, render_data.layout_cache, push_descriptor_set, {},
+    dynamic_buffer_set)),
+    pipeline({get_desc(device, target, render_data)})
+    {
+    }
+    void bind(VkCommandBuffer cmd_buffer, const render_data_t& render_data) const
+    {
+        vkCmdBindPipeline(cmd_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline.handle[0]);
+        VkDeviceSize offset{0};
+        vkCmdBindVertexBuffers(cmd_buffer, 0, 1, &render_data.vertex_buffer.handle, &offset);
+        vkCmdBindIndexBuffer(cmd_buffer, render_data.index_buffer, 0, VK_INDEX_TYPE_UINT32);
+    }
+
+private:
+    data::graphics_pipeline_desc get_desc(const vk::device& device, headless_frame& target, render_data_t& render_data)
+    {
+        auto desc = render_data_t::get_pipeline_desc(target.get_renderpass(), layout, {vertex_shader, render_data.fragment_shader}, device);
+        desc.rendering = target.get_rendering_desc();
+        return desc;
+    }
+};
+
+//what triangle_push.vert and triangle_ubo.vert read per draw
+struct draw_data
+{
+    glm::vec2 offset;
+    float      scale;
+};
+typedef push_constant_t<draw_data, VK_SHADER_STAGE_VERTEX_BIT> draw_push;
+
+/*
+    --bench push : BENCH_DRAWS small triangles per frame, each moved by its own draw_data, once through push constants
+    and once through a uniform buffer. The uniform path writes the frame's draw_data into a mapped buffer and binds its
+    one dynamic uniform set at the draw's offset, which is what feeding a uniform block per draw costs.
+    With VK_KHR_push_descriptor enabled the same uniform slots are also pushed per draw, skipping the allocator.
+*/
+void bench_push_constants(headless_frame& target, render_data_t& render_data, const vk::device& device, VmaAllocator allocator,
+uint frame_count)
+{
+    constexpr uint GRID = 32, BENCH_DRAWS = GRID * GRID;
+    std::vector<draw_data> draws(BENCH_DRAWS);
+    for(uint i = 0; i < BENCH_DRAWS; ++i)
+        draws[i] = draw_data{glm::vec2((i % GRID + 0.5f) * 2.0f / GRID - 1.0f, (i / GRID + 0.5f) * 2.0f / GRID - 1.0f), 1.0f / GRID};
+
+    bench_pipeline_t push_pipeline(device, embedded_shaders::get("triangle_push_vert.spv"), target, render_data);
+    bench_pipeline_t ubo_pipeline(device, embedded_shaders::get("triangle_ubo_vert.spv"), target, render_data, std::nullopt, 0);
+    draw_push push(push_pipeline.layout, device.description.phys_device);
+
+    //one aligned slot per draw and command buffer
+    VkDeviceSize alignment = get::physical_device::get_properties(device.description.phys_device).limits.minUniformBufferOffsetAlignment;
+    VkDeviceSize stride = (sizeof(draw_data) + alignment - 1) / alignment * alignment;
+    VkDeviceSize frame_size = stride * BENCH_DRAWS;
+    vk::buffer uniforms(data::buffer_desc
+    {
+        .parent    = device,
+        .allocator = allocator,
+        .alloc_info = VmaAllocationCreateInfo
+        {
+            .flags = VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT,
+            .usage = VMA_MEMORY_USAGE_AUTO,
+            .requiredFlags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT,
+            .pool = VK_NULL_HANDLE
+        },
+        .size  = frame_size * render_data.command_buffers.description.buffer_count,
+        .usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+        .queue_fam_indices = {device.description.graphics_queue.fam_idx}
+    });
+    char* mapped;
+    vmaMapMemory(allocator, uniforms.description.allocation_object, reinterpret_cast<void**>(&mapped));
+
+    auto pushed = time_frames(target, render_data, frame_count, device, [&](VkCommandBuffer cmd_buffer, uint, const VkViewport&, const VkRect2D&)
+    {
+        push_pipeline.bind(cmd_buffer, render_data);
+        for(const auto& draw : draws)
+        {
+            push.push(cmd_buffer, draw);
+            vkCmdDrawIndexed(cmd_buffer, INDICES.size(), 1, 0, 0, 0);
+        }
+    });
+
+    //a single set for the whole run, the dynamic offset picks the draw's slot
+    vk::descriptor_pool uniform_pool(data::descriptor_pool_desc{.parent = device, .max_sets = 1,
+    .pool_sizes = {{VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 1}}});
+    vk::descriptor_sets uniform_set(data::descriptor_sets_desc{.parent = device, .pool = uniform_pool,
+    .layouts = {ubo_pipeline.layout.description.set_layouts[0]}});
+    VkDescriptorBufferInfo uniform_info{uniforms, 0, sizeof(draw_data)};
+    VkWriteDescriptorSet uniform_write{};
+    uniform_write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    uniform_write.dstSet = uniform_set.handle[0], uniform_write.dstBinding = 0;
+    uniform_write.descriptorCount = 1, uniform_write.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+    uniform_write.pBufferInfo = &uniform_info;
+    vkUpdateDescriptorSets(device, 1, &uniform_write, 0, nullptr);
+
+    auto uniform = time_frames(target, render_data, frame_count, device, [&](VkCommandBuffer cmd_buffer, uint frame_index, const VkViewport&,
+    const VkRect2D&)
+    {
+        VkDeviceSize frame_offset = frame_size * frame_index;
+        for(uint i = 0; i < BENCH_DRAWS; ++i)
+            std::memcpy(mapped + frame_offset + stride * i, &draws[i], sizeof(draw_data));
+        vmaFlushAllocation(allocator, uniforms.description.allocation_object, frame_offset, frame_size);
+
+        ubo_pipeline.bind(cmd_buffer, render_data);
+        for(uint i = 0; i < BENCH_DRAWS; ++i)
+        {
+            uint32_t offset = static_cast<uint32_t>(frame_offset + stride * i);
+            vkCmdBindDescriptorSets(cmd_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, ubo_pipeline.layout, 0, 1, &uniform_set.handle[0], 1, &offset);
+            vkCmdDrawIndexed(cmd_buffer, INDICES.size(), 1, 0, 0, 0);
+        }
+    });
+
+    std::optional<bench_times> push_descriptors;
+    if(device.description.extension_enabled(VK_KHR_PUSH_DESCRIPTOR_EXTENSION_NAME))
+    {
+        bench_pipeline_t pushed_set_pipeline(device, embedded_shaders::get("triangle_ubo_vert.spv"), target, render_data, 0);
+        push_descriptor_t<VkDescriptorBufferInfo> pushed_set(device, pushed_set_pipeline.layout, render_data.layout_cache, 0,
+        {push_descriptor_entry(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 0)});
+        push_descriptors = time_frames(target, render_data, frame_count, device, [&](VkCommandBuffer cmd_buffer, uint frame_index,
+        const VkViewport&, const VkRect2D&)
+        {
+            VkDeviceSize frame_offset = frame_size * frame_index;
+            for(uint i = 0; i < BENCH_DRAWS; ++i)
+                std::memcpy(mapped + frame_offset + stride * i, &draws[i], sizeof(draw_data));
+            vmaFlushAllocation(allocator, uniforms.description.allocation_object, frame_offset, frame_size);
+
+            pushed_set_pipeline.bind(cmd_buffer, render_data);
+            for(uint i = 0; i < BENCH_DRAWS; ++i)
+            {
+                pushed_set.push(cmd_buffer, VkDescriptorBufferInfo{uniforms, frame_offset + stride * i, sizeof(draw_data)});
+                vkCmdDrawIndexed(cmd_buffer, INDICES.size(), 1, 0, 0, 0);
+            }
+        });
+    }
+    vmaUnmapMemory(allocator, uniforms.description.allocation_object);
+
+    INFORM("push : " << BENCH_DRAWS << " draws per frame, " << frame_count << " frames");
+    INFORM("push constants : " << pushed.host_ms << "ms host, " << pushed.wall_ms << "ms wall per frame");
+    INFORM("uniform buffer : " << uniform.host_ms << "ms host, " << uniform.wall_ms << "ms wall per frame");
+    if(push_descriptors.has_value())
+        INFORM("push descriptors : " << push_descriptors->host_ms << "ms host, " << push_descriptors->wall_ms << "ms wall per frame");
+    else
+        INFORM("push descriptors : skipped, VK_KHR_push_descriptor isn't enabled");
+}
+
+/*
+    --bench shader-objects : BENCH_DRAWS triangles per frame, switching between two BRIGHTNESS variants of the triangle
+    before every draw, once as pipelines and once as shader objects. A shader object bind also sets every piece of
+    state the pipeline would have baked in, which is the cost being measured.
+*/
+void bench_shader_objects(headless_frame& target, render_data_t& render_data, const vk::device& device, uint frame_count)
+{
+    if(!render_data.shader_objects.has_value())
+    {
+        INFORM_ERR("shader-objects : needs VK_EXT_shader_object and dynamic rendering");
+        return;
+    }
+    constexpr uint BENCH_DRAWS = 1024;
+    const auto& fragment_reflection = spirv::reflect_cached(render_data.fragment_shader.description.byte_code);
+    std::array<specialization_constants_t, 2> constants;
+    constants[0].set(fragment_reflection, "BRIGHTNESS", 1.0f), constants[1].set(fragment_reflection, "BRIGHTNESS", 0.5f);
+
+    std::vector<vk::graphics_pipeline> pipelines;
+    std::vector<shader_object_pipeline_t> objects;
+    pipelines.reserve(constants.size()), objects.reserve(constants.size());
+    for(const auto& variant : constants)
+    {
+        auto desc = render_data_t::get_pipeline_desc(target.get_renderpass(), render_data.pipeline_layout, {render_data.vertex_shader,
+        render_data.fragment_shader}, device);
+        desc.rendering = target.get_rendering_desc();
+        specialize(desc, variant);
+        pipelines.emplace_back(std::vector<data::graphics_pipeline_desc>{desc});
+        objects.emplace_back(device, render_data.pipeline_layout.description, std::vector<std::reference_wrapper<vk::shader_module>>{
+        render_data.vertex_shader, render_data.fragment_shader}, desc);
+    }
+    auto bind_geometry = [&](VkCommandBuffer cmd_buffer)
+    {
+        VkDeviceSize offset{0};
+        vkCmdBindVertexBuffers(cmd_buffer, 0, 1, &render_data.vertex_buffer.handle, &offset);
+        vkCmdBindIndexBuffer(cmd_buffer, render_data.index_buffer, 0, VK_INDEX_TYPE_UINT32);
+    };
+
+    auto piped = time_frames(target, render_data, frame_count, device, [&](VkCommandBuffer cmd_buffer, uint, const VkViewport&,
+    const VkRect2D&)
+    {
+        bind_geometry(cmd_buffer);
+        for(uint i = 0; i < BENCH_DRAWS; ++i)
+        {
+            vkCmdBindPipeline(cmd_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelines[i % 2].handle[0]);
+            vkCmdDrawIndexed(cmd_buffer, INDICES.size(), 1, 0, 0, 0);
+        }
+    });
+    auto shaded = time_frames(target, render_data, frame_count, device, [&](VkCommandBuffer cmd_buffer, uint, const VkViewport& viewport,
+    const VkRect2D& scissor)
+    {
+        bind_geometry(cmd_buffer);
+        for(uint i = 0; i < BENCH_DRAWS; ++i)
+        {
+            objects[i % 2].bind(cmd_buffer, viewport, scissor);
+            vkCmdDrawIndexed(cmd_buffer, INDICES.size(), 1, 0, 0, 0);
+        }
+    });
+
+    INFORM("shader-objects : " << BENCH_DRAWS << " binds and draws per frame, " << frame_count << " frames");
+    INFORM("pipelines : " << piped.host_ms << "ms host, " << piped.wall_ms << "ms wall per frame");
+    INFORM("shader objects : " << shaded.host_ms << "ms host, " << shaded.wall_ms << "ms wall per frame");
+}
+
+/*
+    --bench robust : robustBufferAccess is fixed when a device is created, so each side runs device_probe_t's dispatch
+    on a throwaway device of its own. That has to happen before the engine's device takes over the device functions,
+    so the device task measures and this only reports. probe.comp does nothing but buffer reads and writes.
+*/
+struct robust_access_times
+{
+    device_probe_t::result_t release;
+    device_probe_t::result_t  robust;
+};
+static std::optional<robust_access_times> bench_robust_access(VkInstance instance, VkPhysicalDevice phys_device)
+{
+    try
+    {
+        return robust_access_times{device_probe_t::run(instance, phys_device, get::device::RELEASE),
+        device_probe_t::run(instance, phys_device, get::device::DEBUG_ROBUST)};
+    }
+    catch(const std::exception& e)
+    {
+        INFORM_ERR("robust : " << e.what());
+        return std::nullopt;
+    }
+}
+static void report_robust_access(const std::optional<robust_access_times>& times)
+{
+    if(!times.has_value())
+        return;
+    INFORM("robust : the device probe's dispatch, on a RELEASE and a DEBUG_ROBUST device");
+    INFORM("release : " << times->release.dispatch_gbps << "GB/s");
+    INFORM("robust buffer access : " << times->robust.dispatch_gbps << "GB/s, "
+    << 100.0 * (1.0 - times->robust.dispatch_gbps / times->release.dispatch_gbps) << "% slower");
+}
+
+/*
+    --bench dispatch : what a call costs through the loader's trampolines, the pointers vkGetInstanceProcAddr hands out,
+    against the driver's own from vkGetDeviceProcAddr, which is what volkLoadDevice put in place for the engine.
+    vkCmdSetViewport is about the cheapest command there is and an empty vkQueueSubmit the cheapest submission,
+    so nearly all of what's timed is the call itself.
+*/
+void bench_dispatch(render_data_t& render_data, const vk::device& device)
+{
+    constexpr uint RECORD_CALLS = 100000, PASSES = 10, SUBMIT_CALLS = 10000;
+    auto loader_set_viewport = reinterpret_cast<PFN_vkCmdSetViewport>(vkGetInstanceProcAddr(*VULKAN, "vkCmdSetViewport"));
+    auto driver_set_viewport = reinterpret_cast<PFN_vkCmdSetViewport>(vkGetDeviceProcAddr(device, "vkCmdSetViewport"));
+    auto loader_submit = reinterpret_cast<PFN_vkQueueSubmit>(vkGetInstanceProcAddr(*VULKAN, "vkQueueSubmit"));
+    auto driver_submit = reinterpret_cast<PFN_vkQueueSubmit>(vkGetDeviceProcAddr(device, "vkQueueSubmit"));
+    if(loader_set_viewport == nullptr || driver_set_viewport == nullptr || loader_submit == nullptr || driver_submit == nullptr)
+    {
+        INFORM_ERR("dispatch : couldn't get the function pointers");
+        return;
+    }
+
+    vkDeviceWaitIdle(device);
+    VkCommandBuffer cmd_buffer = render_data.command_buffers.handle[0];
+    VkViewport viewport{0.0f, 0.0f, 150.0f, 150.0f, 0.0f, 1.0f};
+    //nanoseconds per call, each pass records into a freshly reset command buffer
+    auto time_recording = [&](PFN_vkCmdSetViewport set_viewport) -> double
+    {
+        std::chrono::steady_clock::duration total{};
+        for(uint pass = 0; pass < PASSES; ++pass)
+        {
+            vkResetCommandBuffer(cmd_buffer, 0);
+            VkCommandBufferBeginInfo begin_info{};
+            begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+            begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+            vkBeginCommandBuffer(cmd_buffer, &begin_info);
+            auto start = std::chrono::steady_clock::now();
+            for(uint i = 0; i < RECORD_CALLS; ++i)
+                set_viewport(cmd_buffer, 0, 1, &viewport);
+            total += std::chrono::steady_clock::now() - start;
+            vkEndCommandBuffer(cmd_buffer);
+        }
+        std::chrono::duration<double, std::nano> ns = total;
+        return ns.count() / (RECORD_CALLS * PASSES);
+    };
+    auto time_submits = [&](PFN_vkQueueSubmit submit) -> double
+    {
+        VkSubmitInfo submit_info{};
+        submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        auto start = std::chrono::steady_clock::now();
+        for(uint i = 0; i < SUBMIT_CALLS; ++i)
+            submit(render_data.submit_queue, 1, &submit_info, VK_NULL_HANDLE);
+        std::chrono::duration<double, std::nano> ns = std::chrono::steady_clock::now() - start;
+        vkQueueWaitIdle(render_data.submit_queue);
+        return ns.count() / SUBMIT_CALLS;
+    };
+
+    //one untimed round each, so neither side pays for first use
+    time_recording(driver_set_viewport), time_submits(driver_submit);
+    double loader_record = time_recording(loader_set_viewport), driver_record = time_recording(driver_set_viewport);
+    double loader_submits = time_submits(loader_submit), driver_submits = time_submits(driver_submit);
+    vkResetCommandBuffer(cmd_buffer, 0);
+
+    INFORM("dispatch : " << RECORD_CALLS * PASSES << " vkCmdSetViewport and " << SUBMIT_CALLS << " empty vkQueueSubmit calls per side");
+    INFORM("vkCmdSetViewport : " << loader_record << "ns through the loader, " << driver_record << "ns straight to the driver");
+    INFORM("vkQueueSubmit : " << loader_submits << "ns through the loader, " << driver_submits << "ns straight to the driver");
+}
+
+//percentiles and a coarse histogram of frame times
+static void report_frame_times(const char* name, std::vector<double> frame_ms)
+{
+    if(frame_ms.empty())
+        return;
+    std::sort(frame_ms.begin(), frame_ms.end());
+    auto percentile = [&frame_ms](double p){return frame_ms[std::min(frame_ms.size() - 1, static_cast<size_t>(p * frame_ms.size()))];};
+    INFORM(name << " : p50 " << percentile(0.5) << "ms, p90 " << percentile(0.9) << "ms, p99 " << percentile(0.99) << "ms, max "
+    << frame_ms.back() << "ms");
+
+    constexpr std::array<double, 6> BUCKETS = {1.0, 2.0, 4.0, 8.0, 16.0, 33.0};
+    std::string histogram;
+    auto itr = frame_ms.begin();
+    for(double bucket : BUCKETS)
+    {
+        auto end = std::lower_bound(itr, frame_ms.end(), bucket);
+        histogram += " <" + std::to_string(static_cast<int>(bucket)) + "ms:" + std::to_string(end - itr);
+        itr = end;
+    }
+    histogram += " more:" + std::to_string(frame_ms.end() - itr);
+    INFORM(name << " frames :" << histogram);
+}
+
+/*
+    --bench pipelines : VARIANTS new BRIGHTNESS variants of the triangle requested mid-session, WARM frames in.
+    Once through pipeline_compiler_t, drawing with a fallback until each is ready, and once the blocking way through
+    pipeline_permutations_t, one new variant created inside each frame. Each side's variants are new to the driver.
+    Frame times are taken from the request on, a spike is a frame that waited on a compile.
+*/
+void bench_pipeline_compiles(headless_frame& target, render_data_t& render_data, const vk::device& device, uint frame_count)
+{
+    constexpr uint VARIANTS = 200, WARM = 60;
+    frame_count = std::max(frame_count, WARM + VARIANTS + WARM);
+    const auto& fragment_reflection = spirv::reflect_cached(render_data.fragment_shader.description.byte_code);
+    //first VARIANTS for the compiler, the others for the permutations. Descriptions point into these
+    std::vector<specialization_constants_t> constants(2 * VARIANTS);
+    for(uint i = 0; i < constants.size(); ++i)
+        constants[i].set(fragment_reflection, "BRIGHTNESS", 0.5f + 0.5f * i / constants.size());
+
+    auto base = render_data_t::get_pipeline_desc(target.get_renderpass(), render_data.pipeline_layout, {render_data.vertex_shader,
+    render_data.fragment_shader}, device);
+    base.rendering = target.get_rendering_desc();
+    vk::graphics_pipeline fallback({base});
+    auto bind_geometry = [&](VkCommandBuffer cmd_buffer, VkPipeline pipeline)
+    {
+        vkCmdBindPipeline(cmd_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+        VkDeviceSize offset{0};
+        vkCmdBindVertexBuffers(cmd_buffer, 0, 1, &render_data.vertex_buffer.handle, &offset);
+        vkCmdBindIndexBuffer(cmd_buffer, render_data.index_buffer, 0, VK_INDEX_TYPE_UINT32);
+        vkCmdDrawIndexed(cmd_buffer, INDICES.size(), 1, 0, 0, 0);
+    };
+
+    std::vector<double> async_ms;
+    std::optional<uint> all_ready;
+    {
+        pipeline_compiler_t compiler(std::max(1u, std::thread::hardware_concurrency() / 2));
+        std::vector<async_pipeline_t> variants;
+        uint frame = 0;
+        time_frames(target, render_data, frame_count, device, [&](VkCommandBuffer cmd_buffer, uint, const VkViewport&, const VkRect2D&)
+        {
+            if(frame == WARM)
+                for(uint i = 0; i < VARIANTS; ++i)
+                {
+                    auto desc = base;
+                    specialize(desc, constants[i]);
+                    variants.push_back(compiler.compile(desc, fallback.handle[0]));
+                }
+            if(frame >= WARM && !all_ready.has_value() && compiler.pending() == 0)
+                all_ready = frame - WARM;
+            bind_geometry(cmd_buffer, frame < WARM ? fallback.handle[0] : variants[frame % VARIANTS].get());
+            frame++;
+        }, &async_ms);
+    }
+
+    std::vector<double> blocking_ms;
+    {
+        pipeline_permutations_t permutations;
+        uint32_t permutation_base = permutations.add_base(base);
+        uint frame = 0;
+        time_frames(target, render_data, frame_count, device, [&](VkCommandBuffer cmd_buffer, uint, const VkViewport&, const VkRect2D&)
+        {
+            VkPipeline pipeline = fallback.handle[0];
+            if(frame >= WARM)
+                pipeline = permutations.get(permutation_base, constants[VARIANTS + std::min(frame - WARM, VARIANTS - 1)]);
+            bind_geometry(cmd_buffer, pipeline);
+            frame++;
+        }, &blocking_ms);
+    }
+
+    INFORM("pipelines : " << VARIANTS << " variants requested after " << WARM << " frames, " << frame_count << " frames");
+    if(all_ready.has_value())
+        INFORM("compiler : every variant ready " << all_ready.value() << " frames after the request");
+    else
+        INFORM("compiler : variants still compiling after the last frame");
+    report_frame_times("compiler", std::vector<double>(async_ms.begin() + WARM, async_ms.end()));
+    report_frame_times("blocking", std::vector<double>(blocking_ms.begin() + WARM, blocking_ms.end()));
+}
+
+/*
+    --bench libraries : the triangle pipeline with each of the 16 color write masks, once compiled whole and once
+    through pipeline_library_cache_t, where only the fragment output library differs between them.
+    Neither side gets a pipeline cache, so the whole compiles can't just look each other up.
+*/
+void bench_pipeline_libraries(headless_frame& target, render_data_t& render_data, const vk::device& device)
+{
+    constexpr uint32_t VARIANTS = 16;
+    std::vector<data::graphics_pipeline_desc> descs;
+    for(uint32_t mask = 0; mask < VARIANTS; ++mask)
+    {
+        auto desc = render_data_t::get_pipeline_desc(target.get_renderpass(), render_data.pipeline_layout, {render_data.vertex_shader,
+        render_data.fragment_shader}, device);
+        desc.rendering = target.get_rendering_desc();
+        desc.color_blend_info.attachment_states[0].colorWriteMask = mask;
+        specialize(desc, render_data.triangle_constants);
+        descs.push_back(std::move(desc));
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<vk::graphics_pipeline> whole;
+    for(const auto& desc : descs)
+        whole.emplace_back(std::vector<data::graphics_pipeline_desc>{desc});
+    std::chrono::duration<double, std::milli> whole_ms = std::chrono::steady_clock::now() - start;
+
+    pipeline_library_cache_t libraries(device);
+    start = std::chrono::steady_clock::now();
+    libraries.get(descs[0]);
+    std::chrono::duration<double, std::milli> first_ms = std::chrono::steady_clock::now() - start;
+    for(uint32_t i = 1; i < VARIANTS; ++i)
+        libraries.get(descs[i]);
+    std::chrono::duration<double, std::milli> linked_ms = std::chrono::steady_clock::now() - start;
+
+    INFORM("libraries : " << VARIANTS << " pipelines, " << (libraries.links() ? libraries.links_fast() ? "fast linked" :
+    "linked with link time optimization" : "no VK_EXT_graphics_pipeline_library, compiled whole"));
+    INFORM("whole pipelines : " << whole_ms.count() << "ms, " << whole_ms.count() / VARIANTS << "ms each");
+    INFORM("library cache : " << linked_ms.count() << "ms, " << first_ms.count() << "ms for the first, "
+    << (linked_ms - first_ms).count() / (VARIANTS - 1) << "ms for each other, " << libraries.library_count() << " libraries");
+}
+
+//staging copy of the triangle into device local buffers, on the transfer queue
+void upload_geometry(const vk::device& device, VmaAllocator allocator, std::optional<vk::buffer>& vertex_buffer,
+std::optional<vk::buffer>& index_buffer)
+{
+    vertex_buffer.emplace(data::buffer_desc
+    {
+        .parent    = device,
+        .allocator = allocator,
+        .alloc_info = VmaAllocationCreateInfo
+        {
+            .usage = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE,
+            .requiredFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+            .pool = VK_NULL_HANDLE
+        },
+        .size = sizeof(vertex) * TRIANGLE_VERTICES.size(),
+        //also the source of vertex_animation_t
+        .usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+        .queue_fam_indices = graphics_and_compute_families(device)
+    });
+    index_buffer.emplace(data::buffer_desc
+    {
+        .parent    = device,
+        .allocator = allocator,
+        .alloc_info = VmaAllocationCreateInfo
+        {
+            .usage = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE,
+            .requiredFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+            .pool = VK_NULL_HANDLE
+        },
+        .size = sizeof(uint32_t) * INDICES.size(),
+        .usage = VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+        .queue_fam_indices = {device.description.graphics_queue.fam_idx}
+    });
+    vk::buffer staging_buffer(data::buffer_desc
+    {
+        .parent    = device,
+        .allocator = allocator,
+        .alloc_info = VmaAllocationCreateInfo
+        {
+            .flags = VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT,
+            .usage = VMA_MEMORY_USAGE_AUTO_PREFER_HOST,
+            .requiredFlags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT,
+            .pool = VK_NULL_HANDLE
+        },
+        .size = vertex_buffer->description.size + index_buffer->description.size,
+        .usage =  VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+        .queue_fam_indices = {device.description.transfer_queue.fam_idx}
+    });
+    
+    void* ptr;
+    vmaMapMemory(staging_buffer.description.allocator, staging_buffer.description.allocation_object, &ptr);
+    memcpy(ptr, TRIANGLE_VERTICES.data(), vertex_buffer->description.size);
+    memcpy(ptr + vertex_buffer->description.size, INDICES.data(), index_buffer->description.size);
+    vmaUnmapMemory(staging_buffer.description.allocator, staging_buffer.description.allocation_object);
+
+    vk::cmd_pool staging_pool(data::cmd_pool_desc
+    {
+        .parent = device,
+        .queue_fam_index = device.description.transfer_queue.fam_idx,
+        .flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT
+    });
     vk::cmd_buffers staging_commands(data::cmd_buffers_desc
     {
-        .parent = *device,
+        .parent = device,
         .cmd_pool = staging_pool,
         .buffer_count = 1,
         .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY
@@ -783,15 +2289,15 @@ int main([[maybe_unused]] int argc, [[maybe_unused]] char* argv[])
     copy_info.push_back(VkBufferCopy{
         .srcOffset = 0,
         .dstOffset = 0,
-        .size      = vertex_buffer.description.size
+        .size      = vertex_buffer->description.size
     });
     copy_info.push_back(VkBufferCopy{
-        .srcOffset = vertex_buffer.description.size,
+        .srcOffset = vertex_buffer->description.size,
         .dstOffset = 0,
-        .size      = index_buffer.description.size
+        .size      = index_buffer->description.size
     }); 
-    vkCmdCopyBuffer(staging_commands.handle[0], staging_buffer, vertex_buffer, 1, &copy_info[0]);
-    vkCmdCopyBuffer(staging_commands.handle[0], staging_buffer, index_buffer,  1, &copy_info[1]);
+    vkCmdCopyBuffer(staging_commands.handle[0], staging_buffer, *vertex_buffer, 1, &copy_info[0]);
+    vkCmdCopyBuffer(staging_commands.handle[0], staging_buffer, *index_buffer,  1, &copy_info[1]);
 
     vkEndCommandBuffer(staging_commands.handle[0]);
     VkSubmitInfo submit_info
@@ -800,18 +2306,238 @@ int main([[maybe_unused]] int argc, [[maybe_unused]] char* argv[])
         .commandBufferCount = 1,
         .pCommandBuffers = &staging_commands.handle[0]
     };
-    auto queue_handle = get::device::queue_handle(*device, device->description.transfer_queue);
+    auto queue_handle = get::device::queue_handle(device, device.description.transfer_queue);
     vkQueueSubmit(queue_handle, 1, &submit_info, VK_NULL_HANDLE);
 
     vkQueueWaitIdle(queue_handle);
+}
+/*
+    part of --timings : what the capability snapshots save at startup. Every get() during startup used to be a round
+    of driver queries, now only the first per device is. Querying every device again times one round.
+*/
+void report_capability_queries(uint64_t startup_lookups)
+{
+    auto begin = std::chrono::steady_clock::now();
+    for(auto handle : PHYSICAL_DEVICES)
+        vk::device_capabilities_t::query(handle);
+    double round_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+    double per_query_ms = round_ms / PHYSICAL_DEVICES.size();
+    uint64_t saved = startup_lookups > PHYSICAL_DEVICES.size() ? startup_lookups - PHYSICAL_DEVICES.size() : 0;
+    INFORM("capabilities : " << startup_lookups << " lookups over " << PHYSICAL_DEVICES.size() << " devices, "
+    << per_query_ms << "ms per driver query");
+    INFORM("capabilities : about " << saved * per_query_ms << "ms of driver queries saved");
+}
+//parses the shaders ahead of render_data_t, which then finds them in the reflection cache
+void reflect_embedded_shaders()
+{
+    //a few hundred bytes each, parsing all of them costs less than keeping a list
+    for(const auto& shader : embedded_shaders::table)
+    {
+        const char* bytes = reinterpret_cast<const char*>(shader.code);
+        spirv::reflect_cached(std::vector<char>(bytes, bytes + shader.size));
+    }
+}
 
-    render_data_t render_data(*device, my_frame.get_renderpass(), FRAMES_IN_FLIGHT, vertex_buffer, index_buffer);
+int main([[maybe_unused]] int argc, [[maybe_unused]] char* argv[])
+{
+    launch_options options(argc, argv);
+    startup_timings_t timings;
+    constexpr uint FRAMES_IN_FLIGHT = 2;
+    constexpr uint ATLAS_SIZE = 1024;
+    const bool windowed = !options.headless;
 
-    while(!glfwWindowShouldClose(my_frame.get_window_handle()))
+    //declared in the order they must be destroyed in, reversed. The startup tasks fill them in
+    vulkan_context context;
+    vk::shared_device device;
+    std::optional<vk::allocator> allocator;
+    std::optional<vk::buffer> vertex_buffer, index_buffer;
+    std::optional<readback_ring_t> readback;
+    std::optional<frame> window_frame;
+    std::optional<multi_frame> window_frames;
+    std::optional<headless_frame> headless_target;
+    std::optional<batch_renderer> batch;
+    std::optional<render_data_t> render_data;
+    pipeline_files_t pipeline_files;
+    std::optional<robust_access_times> robust_times;
+
+    /*
+        context -> device -> allocator -> geometry upload ----------> render data
+                          \-> target (window, headless or atlas) -----/
+        pipeline files, shader reflection ----------------------------/
+        GLFW wants the context and windows on the main thread, the rest runs on the workers.
+    */
+    task_graph_t startup;
+    auto context_task = startup.add("context", {}, [&]()
+    {
+        context.start(true, options.headless, &timings);    //this will enforce correct destruction order
+    }, task_graph_t::MAIN_THREAD);
+    auto files_task = startup.add("pipeline files", {}, [&](){pipeline_files = pipeline_files_t::read();});
+    auto reflect_task = startup.add("shader reflection", {}, reflect_embedded_shaders);
+    auto device_task = startup.add("device", {context_task}, [&]()
+    {
+        //measured bandwidth settles ties the reported properties can't, e.g. two GPUs in a hybrid laptop
+        std::optional<device_probe_t> probe;
+        get::physical_device::score_fnc bonus = nullptr;
+        if(options.probe)
+        {
+            probe.emplace(DEVICE_PROBE_PATH);
+            bonus = [&probe](VkPhysicalDevice candidate){return probe->score(*VULKAN, candidate);};
+        }
+        auto picked = get::physical_device::pick_best_physical_device(PHYSICAL_DEVICES, bonus);
+        if(probe.has_value() && !probe->save())
+            INFORM_ERR("WARNING : failed to write " << DEVICE_PROBE_PATH);
+        if(options.bench == "robust")
+            robust_times = bench_robust_access(*VULKAN, picked);
+
+        device = std::make_shared<vk::device>(get::device::description(*VULKAN, picked, options.headless, options.features));
+        /*
+            the engine drives a single device, so its functions can replace the loader's trampolines for every caller,
+            wrappers and VMA included (get::vma_functions() copies them after this). Nothing else touches vulkan while
+            this task runs, every other vulkan task depends on it
+        */
+        if(volkGetLoadedDevice() != VK_NULL_HANDLE)
+            THROW("ANOTHER DEVICE ALREADY OWNS THE DEVICE FUNCTIONS");
+        volkLoadDevice(*device);
+    });
+    auto allocator_task = startup.add("allocator", {device_task}, [&]()
+    {
+        auto funcs = get::vma_functions();
+        allocator.emplace(VmaAllocatorCreateInfo{
+            .physicalDevice   = device->description.phys_device,
+            .device           = *device,
+            .pVulkanFunctions = &funcs,
+            .instance         = *VULKAN
+        });
+    });
+    auto upload_task = startup.add("geometry upload", {allocator_task}, [&]()
     {
-        glfwPollEvents();
-        my_frame.draw_frames(render_triangles, render_data);       
+        upload_geometry(*device, *allocator, vertex_buffer, index_buffer);
+    });
+
+    VkRenderPass target_renderpass = VK_NULL_HANDLE;
+    std::optional<data::rendering_desc> target_rendering;
+    uint command_buffer_count = FRAMES_IN_FLIGHT;
+    auto target_task = startup.add("target", {allocator_task}, [&]()
+    {
+        if(options.batch)
+        {
+            readback.emplace(*device, *allocator, FRAMES_IN_FLIGHT + 1, ATLAS_SIZE * ATLAS_SIZE * texel_size(headless_frame::DEFAULT_FORMAT));
+            batch.emplace(ATLAS_SIZE, ATLAS_SIZE, FRAMES_IN_FLIGHT, device, *allocator, *readback);
+            target_renderpass = batch->get_renderpass(), target_rendering = batch->get_rendering_desc();
+        }
+        else if(options.headless)
+        {
+            headless_target.emplace(150, 150, FRAMES_IN_FLIGHT, device, *allocator);
+            //one slot per frame in flight, plus room for the host to fall behind a little
+            readback.emplace(*device, *allocator, FRAMES_IN_FLIGHT + 2, 150 * 150 * texel_size(headless_frame::DEFAULT_FORMAT));
+            target_renderpass = headless_target->get_renderpass(), target_rendering = headless_target->get_rendering_desc();
+        }
+        else if(options.window_count > 1)
+        {
+            std::vector<multi_frame::window_desc> descriptions(options.window_count, multi_frame::window_desc{150, 150, "title"});
+            window_frames.emplace(descriptions, FRAMES_IN_FLIGHT, device);
+            target_renderpass = window_frames->get_renderpass(), target_rendering = window_frames->get_rendering_desc();
+            command_buffer_count = window_frames->get_command_buffer_count();
+        }
+        else
+        {
+            window_frame.emplace(150, 150, "title", FRAMES_IN_FLIGHT, device);
+            target_renderpass = window_frame->get_renderpass(), target_rendering = window_frame->get_rendering_desc();
+        }
+    }, windowed ? task_graph_t::MAIN_THREAD : task_graph_t::ANY_THREAD);
+    startup.add("render data", {upload_task, target_task, files_task, reflect_task}, [&]()
+    {
+        render_data.emplace(*device, target_renderpass, target_rendering, command_buffer_count, *vertex_buffer, *index_buffer,
+        std::move(pipeline_files));
+        if(options.animate)
+            render_data->start_animation(*device, *allocator);
+    });
+    startup.run();
+    if(options.timings)
+    {
+        timings.report();
+        startup.report();
+        report_capability_queries(vk::device_capabilities_t::lookups());
+    }
+
+    /*
+        frames submitted before the pipeline is ready only clear, the first draw is the one with geometry. A frame counts
+        once its fence signals, the GPU is done with it then and presenting is all that's left. Waiting stalls the
+        loop, but only for those two frames and only with --timings
+    */
+    bool first_frame = true, first_draw = true;
+    auto frame_drawn = [&](VkFence submitted)
+    {
+        if(!options.timings || submitted == VK_NULL_HANDLE || (!first_frame && !first_draw))
+            return;
+        bool drawing = render_data->shader_objects.has_value() || render_data->graphics_pipeline.get_status() != async_pipeline_t::PENDING;
+        if(!first_frame && !drawing)
+            return;
+        vkWaitForFences(*device, 1, &submitted, VK_TRUE, UINT64_MAX);
+        if(first_frame)
+            INFORM("first frame rendered after " << startup.elapsed_ms() << "ms");
+        if(first_draw && drawing)
+            INFORM("first frame with geometry rendered after " << startup.elapsed_ms() << "ms");
+        first_frame = false, first_draw = first_draw && !drawing;
+    };
+
+    if(options.bench == "push")
+        bench_push_constants(*headless_target, *render_data, *device, *allocator, options.headless_frames);
+    else if(options.bench == "shader-objects")
+        bench_shader_objects(*headless_target, *render_data, *device, options.headless_frames);
+    else if(options.bench == "robust")
+        report_robust_access(robust_times);
+    else if(options.bench == "dispatch")
+        bench_dispatch(*render_data, *device);
+    else if(options.bench == "pipelines")
+        bench_pipeline_compiles(*headless_target, *render_data, *device, options.headless_frames);
+    else if(options.bench == "libraries")
+        bench_pipeline_libraries(*headless_target, *render_data, *device);
+    else if(!options.bench.empty())
+        INFORM_ERR("no benchmark named " << options.bench);
+    else if(options.batch)
+        run_batch(*batch, *render_data, *readback, options.batch_jobs, *device);
+    else if(options.headless)
+    {
+        uint64_t captured_bytes = 0;
+        if(options.capture)
+            headless_target->set_readback(&*readback, [&captured_bytes](const void*, VkDeviceSize size){captured_bytes += size;});
+        run_headless(*headless_target, *render_data, options.headless_frames, *device, frame_drawn);
+        if(options.capture)
+        {
+            readback->flush();
+            INFORM("capture : " << readback->get_completed() << " frames, " << captured_bytes << " bytes, " << readback->get_dropped()
+            << " dropped");
+        }
+    }
+    else if(window_frames.has_value())
+    {
+        auto any_closed = [&window_frames]()
+        {
+            for(size_t i = 0; i < window_frames->get_window_count(); ++i)
+                if(glfwWindowShouldClose(window_frames->get_window_handle(i)))
+                    return true;
+            return false;
+        };
+        while(!any_closed())
+        {
+            glfwPollEvents();
+            window_frames->draw_frames(render_triangles, *render_data);
+            frame_drawn(window_frames->get_submitted_fence());
+        }
+    }
+    else
+    {
+        while(!glfwWindowShouldClose(window_frame->get_window_handle()))
+        {
+            glfwPollEvents();
+            window_frame->draw_frames(render_triangles, *render_data);
+            frame_drawn(window_frame->get_submitted_fence());
+        }
     }
     vkDeviceWaitIdle(*device);
+    //benchmarks compile throwaway variants, the next session shouldn't warm up with them
+    if(options.bench.empty())
+        render_data->pipelines.save();
     return 0;
-}
\ No newline at end of file
+}
@@ -3,9 +3,13 @@
 #include "vulkan_handle.h"
 #include "vulkan_handle_description.h"
 #include "vulkan_handle_util.h"
+#include "device_capabilities.h"
 
 #include "GLFW/glfw3.h"
 
+#include <cmath>
+#include <functional>
+
 
 namespace vk_handle::data_getters
 {
@@ -104,47 +108,94 @@ namespace vk_handle::data_getters
             for(const auto& handle : handles)
             {
                 physical_devices.push_back(handle);
-                auto props = get_properties(handle);
+                const auto& props = get_properties(handle);
                 INFORM("Physical device determined : " << props.deviceName);
             }
             return physical_devices;
         }
-        static bool supports_extensions(VkPhysicalDevice device, std::vector<std::string> extensions)
+        static bool supports_extensions(VkPhysicalDevice device, const std::vector<std::string>& extensions)
         {
-            auto props = get_properties(device);
-            INFORM(props.deviceName << " : ");
-            auto avlbl_ext = get_available_extensions(device);
-            return check_support(avlbl_ext, extensions);
+            return device_capabilities_t::get(device).extensions.contains(extensions);
         }
-        static VkPhysicalDevice pick_best_physical_device(std::vector<VkPhysicalDevice> devices)
+        //extra points for a device on top of score(), e.g. from device_probe_t
+        typedef std::function<double (VkPhysicalDevice)> score_fnc;
+        /*
+            ranks what the device reports about itself : its type first, then memory, limits, queue topology and the optional
+            extensions the engine makes use of. Devices without a graphics queue can't run the engine and score below zero.
+            The type weights are larger than everything else combined, so an integrated GPU with more shared memory than a
+            discrete one still loses to it, only a measured bonus can say otherwise.
+        */
+        static double score(VkPhysicalDevice handle)
         {
-            std::map<VkDeviceSize, VkPhysicalDevice> device_memory_size; //sorted ascending
-            for(size_t i = 0; i < devices.size(); ++i)
+            const auto& caps = device_capabilities_t::get(handle);
+            const auto& props = caps.properties;
+
+            bool graphics = false, dedicated_compute = false, dedicated_transfer = false;
+            for(const auto& family : caps.queue_families)
             {
-                device_memory_size.insert({get_local_memory_size(devices[i]), devices[i]});
+                graphics = graphics || (family.queueFlags & VK_QUEUE_GRAPHICS_BIT);
+                if((family.queueFlags & VK_QUEUE_COMPUTE_BIT) && !(family.queueFlags & VK_QUEUE_GRAPHICS_BIT))
+                    dedicated_compute = true;
+                if((family.queueFlags & VK_QUEUE_TRANSFER_BIT) && !(family.queueFlags & (VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT)))
+                    dedicated_transfer = true;
             }
-            
-            auto picked_device = (*device_memory_size.rbegin()).second;
-            auto device_mem_size = (*device_memory_size.rbegin()).first;
-            for(auto itr = device_memory_size.rbegin(); itr != device_memory_size.rend(); ++itr)
+            if(!graphics)
+                return -1.0;
+
+            double result = 0.0;
+            switch(props.deviceType)
             {
-                auto props = get_properties((*itr).second);
-                if (props.deviceType == VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU
-                || props.deviceType == VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU)
-                {
-                    picked_device = (*itr).second;
-                    device_mem_size = (*itr).first;
-                }
+                case VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU   : result += 4000.0; break;
+                case VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU : result += 2000.0; break;
+                case VK_PHYSICAL_DEVICE_TYPE_VIRTUAL_GPU    : result += 1000.0; break;
+                case VK_PHYSICAL_DEVICE_TYPE_CPU            : break;
+                default                                     : result += 500.0; break;
+            }
+
+            double local_gib = static_cast<double>(get_local_memory_size(handle)) / double(1 << 30);
+            result += 100.0 * std::log2(1.0 + local_gib);
+
+            result += 10.0 * std::log2(1.0 + props.limits.maxImageDimension2D);
+            result += 10.0 * std::log2(1.0 + props.limits.maxComputeSharedMemorySize / 1024.0);
+            result += 10.0 * std::log2(1.0 + props.limits.maxPerStageDescriptorSampledImages);
+
+            result += dedicated_compute  ? 100.0 : 0.0;
+            result += dedicated_transfer ? 100.0 : 0.0;
+
+            result += props.apiVersion >= VK_API_VERSION_1_2 ? 100.0 : 0.0;
+            result += props.apiVersion >= VK_API_VERSION_1_3 ? 100.0 : 0.0;
+            for(auto optional : {DESCRIPTOR_INDEXING, PUSH_DESCRIPTOR, GRAPHICS_PIPELINE_LIBRARY, EXTENDED_DYNAMIC_STATE,
+            EXTENDED_DYNAMIC_STATE_2, EXTENDED_DYNAMIC_STATE_3, DYNAMIC_RENDERING, SHADER_OBJECT})
+                result += caps.extensions.contains(get_required_extension_names(optional)) ? 50.0 : 0.0;
+            return result;
+        }
+        //highest score() plus bonus wins, ties go to the device listed first
+        static VkPhysicalDevice pick_best_physical_device(const std::vector<VkPhysicalDevice>& devices, score_fnc bonus = nullptr,
+        bool throws = true)
+        {
+            VkPhysicalDevice picked_device = VK_NULL_HANDLE;
+            double best = 0.0;
+            for(const auto& handle : devices)
+            {
+                double points = score(handle);
+                if(points >= 0.0 && bonus)
+                    points += bonus(handle);
+                INFORM(get_properties(handle).deviceName << " scores " << points);
+                if(points >= 0.0 && (picked_device == VK_NULL_HANDLE || points > best))
+                    picked_device = handle, best = points;
             }
-            auto props = get_properties(picked_device);
-            INFORM("Picked " << props.deviceName << "\nWith " << device_mem_size << " Bytes of local memory.");
+            if(picked_device == VK_NULL_HANDLE && throws)
+                THROW("NO SUITABLE PHYSICAL DEVICE");
 
+            if(picked_device != VK_NULL_HANDLE)
+                INFORM("Picked " << get_properties(picked_device).deviceName << "\nWith " << get_local_memory_size(picked_device)
+                << " Bytes of local memory.");
             return picked_device;
         }
         static VkDeviceSize get_local_memory_size(VkPhysicalDevice physical_device)
         {
             VkDeviceSize device_memory_size{};
-            auto mem_props = get_memory_properties(physical_device);
+            const auto& mem_props = get_memory_properties(physical_device);
             for(uint32_t j = 0; j < mem_props.memoryHeapCount; ++j)
                 if(mem_props.memoryHeaps[j].flags & VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT)
                     device_memory_size += mem_props.memoryHeaps[j].size;
@@ -153,66 +204,124 @@ namespace vk_handle::data_getters
         
         enum extension_enable_flag_bits
         {
-            SWAPCHAIN         = 0b001
+            SWAPCHAIN                 = 0b000000001,
+            DESCRIPTOR_INDEXING       = 0b000000010,   //only needed below 1.2
+            PUSH_DESCRIPTOR           = 0b000000100,
+            GRAPHICS_PIPELINE_LIBRARY = 0b000001000,
+            DYNAMIC_RENDERING         = 0b000010000,   //its dependencies are core in 1.2
+            EXTENDED_DYNAMIC_STATE    = 0b000100000,
+            EXTENDED_DYNAMIC_STATE_2  = 0b001000000,
+            EXTENDED_DYNAMIC_STATE_3  = 0b010000000,
+            SHADER_OBJECT             = 0b100000000,   //needs DYNAMIC_RENDERING
         };
         static std::vector<std::string> get_required_extension_names(uint flags)
         {
             std::vector<std::string> names;
             if(flags & SWAPCHAIN)
                 names.push_back(VK_KHR_SWAPCHAIN_EXTENSION_NAME);
+            if(flags & DESCRIPTOR_INDEXING)
+            {
+                names.push_back(VK_KHR_MAINTENANCE3_EXTENSION_NAME);
+                names.push_back(VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME);
+            }
+            if(flags & PUSH_DESCRIPTOR)
+                names.push_back(VK_KHR_PUSH_DESCRIPTOR_EXTENSION_NAME);
+            if(flags & GRAPHICS_PIPELINE_LIBRARY)
+            {
+                names.push_back(VK_KHR_PIPELINE_LIBRARY_EXTENSION_NAME);
+                names.push_back(VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME);
+            }
+            if(flags & DYNAMIC_RENDERING)
+                names.push_back(VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME);
+            if(flags & EXTENDED_DYNAMIC_STATE)
+                names.push_back(VK_EXT_EXTENDED_DYNAMIC_STATE_EXTENSION_NAME);
+            if(flags & EXTENDED_DYNAMIC_STATE_2)
+                names.push_back(VK_EXT_EXTENDED_DYNAMIC_STATE_2_EXTENSION_NAME);
+            if(flags & EXTENDED_DYNAMIC_STATE_3)
+                names.push_back(VK_EXT_EXTENDED_DYNAMIC_STATE_3_EXTENSION_NAME);
+            if(flags & SHADER_OBJECT)
+                names.push_back(VK_EXT_SHADER_OBJECT_EXTENSION_NAME);
             return names;
         }
 
-        static std::vector<VkQueueFamilyProperties> get_queue_fams(VkPhysicalDevice handle)
+        //the getters below read the device's capability snapshot, only the first call per device asks the driver
+        static const std::vector<VkQueueFamilyProperties>& get_queue_fams(VkPhysicalDevice handle)
         {
-            std::vector<VkQueueFamilyProperties> queue_fams;
-            uint32_t count;
-            vkGetPhysicalDeviceQueueFamilyProperties(handle, &count, nullptr);
-            queue_fams.resize(count);
-            vkGetPhysicalDeviceQueueFamilyProperties(handle, &count, queue_fams.data());
-            return queue_fams;
+            return device_capabilities_t::get(handle).queue_families;
         }
-        static std::vector<std::string> get_available_extensions(VkPhysicalDevice handle)
+        static const std::vector<std::string>& get_available_extensions(VkPhysicalDevice handle)
         {
-            std::vector<std::string> available_extensions;
-            uint32_t count;
-            vkEnumerateDeviceExtensionProperties(handle, nullptr, &count, nullptr);
-            VkExtensionProperties* ptr = new VkExtensionProperties[count];
-            vkEnumerateDeviceExtensionProperties(handle, nullptr, &count, ptr);
-
-            available_extensions.resize(count);
-            for(size_t i = 0; i < count; ++i)
-                available_extensions[i] = std::string(ptr[i].extensionName);
-            delete[] ptr;
-            return available_extensions;
+            return device_capabilities_t::get(handle).extension_names;
         }
-        static VkPhysicalDeviceMemoryProperties get_memory_properties(VkPhysicalDevice handle)
+        static const VkPhysicalDeviceMemoryProperties& get_memory_properties(VkPhysicalDevice handle)
         {
-            VkPhysicalDeviceMemoryProperties memory_properties;
-            vkGetPhysicalDeviceMemoryProperties(handle, &memory_properties);
-            return memory_properties;
+            return device_capabilities_t::get(handle).memory_properties;
         }
-        static VkPhysicalDeviceProperties get_properties(VkPhysicalDevice handle)
+        static const VkPhysicalDeviceProperties& get_properties(VkPhysicalDevice handle)
         {
-            VkPhysicalDeviceProperties f;
-            vkGetPhysicalDeviceProperties(handle, &f);
-            return f;
+            return device_capabilities_t::get(handle).properties;
         }
-        static VkPhysicalDeviceFeatures get_features(VkPhysicalDevice handle)
+        static const VkPhysicalDeviceFeatures& get_features(VkPhysicalDevice handle)
         {
-            VkPhysicalDeviceFeatures f;
-            vkGetPhysicalDeviceFeatures(handle, &f);
-            return f;
+            return device_capabilities_t::get(handle).features;
         }
-        //don't call this frequently
-        static vk_handle::description::surface_features get_surface_features(VkInstance instance, VkPhysicalDevice handle)
+        //returns nothing if the device can't report it (below 1.1)
+        static std::optional<VkPhysicalDeviceDescriptorIndexingFeatures> get_descriptor_indexing_features(VkPhysicalDevice handle)
         {
-            glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
-            auto glfw = glfwCreateWindow(1, 1, "", nullptr, nullptr);
-            vk_handle::surface srf(vk_handle::description::surface_desc{instance, glfw});
-            auto result = get_swapchain_features(get_swapchain_support(handle, srf), glfw);   
-            glfwDestroyWindow(glfw);
-            return result;
+            return device_capabilities_t::get(handle).descriptor_indexing_features;
+        }
+        static const VkPhysicalDeviceDescriptorIndexingProperties& get_descriptor_indexing_properties(VkPhysicalDevice handle)
+        {
+            return device_capabilities_t::get(handle).descriptor_indexing_properties;
+        }
+        //returns nothing below 1.1 or without the extension
+        static std::optional<VkPhysicalDeviceGraphicsPipelineLibraryFeaturesEXT> get_graphics_pipeline_library_features(VkPhysicalDevice handle)
+        {
+            if(!supports_extensions(handle, get_required_extension_names(GRAPHICS_PIPELINE_LIBRARY)))
+                return std::nullopt;
+            return device_capabilities_t::get(handle).graphics_pipeline_library_features;
+        }
+        static const VkPhysicalDeviceGraphicsPipelineLibraryPropertiesEXT& get_graphics_pipeline_library_properties(VkPhysicalDevice handle)
+        {
+            return device_capabilities_t::get(handle).graphics_pipeline_library_properties;
+        }
+        //returns nothing below 1.2 or without the extension
+        static std::optional<VkPhysicalDeviceDynamicRenderingFeaturesKHR> get_dynamic_rendering_features(VkPhysicalDevice handle)
+        {
+            return device_capabilities_t::get(handle).dynamic_rendering_features;
+        }
+        //returns nothing below 1.1 or without the extension
+        static std::optional<VkPhysicalDeviceShaderObjectFeaturesEXT> get_shader_object_features(VkPhysicalDevice handle)
+        {
+            return device_capabilities_t::get(handle).shader_object_features;
+        }
+        //any of the three is nothing below 1.1 or without its extension
+        static void get_extended_dynamic_state_features(VkPhysicalDevice handle,
+        std::optional<VkPhysicalDeviceExtendedDynamicStateFeaturesEXT>&   eds,
+        std::optional<VkPhysicalDeviceExtendedDynamicState2FeaturesEXT>& eds2,
+        std::optional<VkPhysicalDeviceExtendedDynamicState3FeaturesEXT>& eds3)
+        {
+            const auto& caps = device_capabilities_t::get(handle);
+            eds  = caps.extended_dynamic_state_features;
+            eds2 = caps.extended_dynamic_state_2_features;
+            eds3 = caps.extended_dynamic_state_3_features;
+        }
+        //the subset of descriptor indexing the bindless heap relies on
+        static bool supports_bindless(const VkPhysicalDeviceDescriptorIndexingFeatures& f)
+        {
+            return f.runtimeDescriptorArray && f.descriptorBindingPartiallyBound && f.descriptorBindingStorageBufferUpdateAfterBind
+            && f.descriptorBindingSampledImageUpdateAfterBind && f.shaderSampledImageArrayNonUniformIndexing;
+        }
+        //formats and present modes never change for a surface, only the capabilities (the extent) are queried again
+        //when support already holds an earlier answer for the same surface
+        static vk_handle::description::surface_features get_surface_features(VkPhysicalDevice handle, const vk_handle::surface& srf,
+        vk_handle::description::surface_support& support)
+        {
+            if(support.surface_formats.empty())
+                support = get_swapchain_support(handle, srf);
+            else
+                vkGetPhysicalDeviceSurfaceCapabilitiesKHR(handle, srf, &support.surface_capabilities);
+            return get_swapchain_features(support, srf.description.glfw_interface);
         }
     };
 
@@ -224,14 +333,11 @@ namespace vk_handle::data_getters
             vkGetDeviceQueue(device, queue_desc.fam_idx, queue_desc.index_in_family, &handle);
             return handle;
         }
+        //headless : nothing is presented, the present queue is the graphics queue and no window is created
         static bool find_queue_indices(const VkInstance instance, const VkPhysicalDevice phys_device, vk_handle::description::family_indices& indices,
-        bool throws = true)
+        bool headless = false, bool throws = true)
         {
-            auto queue_fams = physical_device::get_queue_fams(phys_device);
-
-            glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
-            auto glfw_window = glfwCreateWindow(1, 1, "dummy", nullptr, nullptr);
-            vk_handle::surface dummy_surface{vk_handle::description::surface_desc{instance, glfw_window}}; //just to check support
+            const auto& queue_fams = physical_device::get_queue_fams(phys_device);
 
             //find family indices
             for(uint32_t i = 0; i < queue_fams.size(); ++i)
@@ -243,16 +349,18 @@ namespace vk_handle::data_getters
                     if((queue_fams[i].queueFlags & (VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT)) == 0)
                         indices.transfer = family_index{i, TRANSFER_BIT};
                 if(queue_fams[i].queueFlags & VK_QUEUE_COMPUTE_BIT)
-                    if((queue_fams[i].queueCount & VK_QUEUE_GRAPHICS_BIT) == 0)
+                    if((queue_fams[i].queueFlags & VK_QUEUE_GRAPHICS_BIT) == 0)
                         indices.compute  = family_index{i, COMPUTE_BIT};
 
-                VkBool32 supports_present;
-                vkGetPhysicalDeviceSurfaceSupportKHR(phys_device, i, dummy_surface, &supports_present);
-                if(supports_present)
+                if(headless)
+                    continue;
+                //asks the platform directly, no window or surface needed
+                if(glfwGetPhysicalDevicePresentationSupport(instance, phys_device, i) == GLFW_TRUE)
                     indices.present = family_index{i, PRESENT_BIT};
             }
-            //cleanup
-            glfwDestroyWindow(glfw_window);
+            if(headless && indices.graphics.has_value())
+                indices.present = vk_handle::description::family_index{static_cast<uint32_t>(indices.graphics.value()),
+                vk_handle::description::PRESENT_BIT};
             //find fallbacks
             if(!indices.transfer.has_value())   //use a graphics queue
             {
@@ -274,18 +382,18 @@ namespace vk_handle::data_getters
         //sets the queue members of device and the value you should pass to the handle's description
         //this function does too much. It should be split into two functions
         static bool determine_queues(const VkInstance instance, vk_handle::description::device_desc& device, VkPhysicalDevice phys_dev,
-        std::vector<vk_handle::description::device_queue>& device_queues, bool throws = true)
+        std::vector<vk_handle::description::device_queue>& device_queues, bool headless = false, bool throws = true)
         {
             using namespace vk_handle::description;
 
             family_indices indices;
-            find_queue_indices(instance, phys_dev, indices, throws);
+            find_queue_indices(instance, phys_dev, indices, headless, throws);
             //determine device queues 
             /*
             the spec states that each device queue should refer to a unique family index.
             Since the family indices above are not necessarily unique, we must check for that
             */
-            auto queue_fams = physical_device::get_queue_fams(phys_dev);
+            const auto& queue_fams = physical_device::get_queue_fams(phys_dev);
 
             //combine non-unique indices
             std::vector<family_index> unique_indices({indices.graphics.value(), indices.compute.value(), indices.transfer.value(), indices.present.value()});
@@ -388,27 +496,181 @@ namespace vk_handle::data_getters
             list_queue_props(desc.present_queue);
         }
         
-        static vk_handle::description::device_desc description(const VkInstance instance, const VkPhysicalDevice phys_device)
+        //which core features the device is created with. Whatever a profile doesn't name stays off, even when supported
+        enum feature_profile
+        {
+            MINIMAL,        //nothing the engine can do without
+            RELEASE,        //what the engine's code paths can make use of
+            DEBUG_ROBUST,   //RELEASE with bounds checked buffer access, out of range reads return zero
+        };
+        /*
+            robustBufferAccess makes the driver guard every buffer access in every shader, so only DEBUG_ROBUST asks for it.
+            Features the capability snapshot says the device lacks are dropped with a warning.
+            The per version structs are filled when the device and the instance both reach that version, see
+            device_desc::get_create_info for how the extension structs they absorbed fold into them.
+        */
+        static void enable_profile_features(vk_handle::description::device_desc& description, VkPhysicalDevice phys_device,
+        feature_profile profile)
+        {
+            const auto& caps = device_capabilities_t::get(phys_device);
+            uint32_t version = std::min(caps.properties.apiVersion, ENGINE_API_VERSION);
+
+            VkPhysicalDeviceFeatures features{};
+            if(profile != MINIMAL)
+            {
+                features.samplerAnisotropy = VK_TRUE;   //sampler_desc::max_anisotropy
+                features.fillModeNonSolid  = VK_TRUE;   //line polygon mode through the pipeline or draw_state_t
+                features.depthClamp        = VK_TRUE;   //same for depth clamp
+                features.logicOp           = VK_TRUE;   //color_blend_info::logic_op_enabled
+            }
+            //bindless_heap_t indexes its arrays with whatever the shader computes
+            if(description.descriptor_indexing_features.has_value())
+            {
+                features.shaderSampledImageArrayDynamicIndexing  = VK_TRUE;
+                features.shaderStorageBufferArrayDynamicIndexing = VK_TRUE;
+            }
+            if(profile == DEBUG_ROBUST)
+                features.robustBufferAccess = VK_TRUE;
+
+            //VkPhysicalDeviceFeatures is nothing but VkBool32s
+            constexpr size_t feature_count = sizeof(VkPhysicalDeviceFeatures) / sizeof(VkBool32);
+            auto* wanted = reinterpret_cast<VkBool32*>(&features);
+            const auto* supported = reinterpret_cast<const VkBool32*>(&caps.features);
+            for(size_t i = 0; i < feature_count; ++i)
+                if(wanted[i] && !supported[i])
+                {
+                    INFORM("WARNING : core feature " << i << " of the profile is not supported, left disabled");
+                    wanted[i] = VK_FALSE;
+                }
+            description.enabled_features = features;
+
+            //descriptor indexing is the only 1.2 feature the engine uses, nothing it needs came with 1.1.
+            //on a 1.2 device the indexing struct can't be chained next to the 1.2 one, so its bits move here
+            if(version < VK_API_VERSION_1_2 || !description.descriptor_indexing_features.has_value())
+                return;
+            const auto& indexing = description.descriptor_indexing_features.value();
+            VkPhysicalDeviceVulkan12Features v12{};
+            v12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+            v12.runtimeDescriptorArray                        = indexing.runtimeDescriptorArray;
+            v12.descriptorBindingPartiallyBound               = indexing.descriptorBindingPartiallyBound;
+            v12.descriptorBindingStorageBufferUpdateAfterBind = indexing.descriptorBindingStorageBufferUpdateAfterBind;
+            v12.descriptorBindingSampledImageUpdateAfterBind  = indexing.descriptorBindingSampledImageUpdateAfterBind;
+            v12.shaderSampledImageArrayNonUniformIndexing     = indexing.shaderSampledImageArrayNonUniformIndexing;
+            v12.shaderStorageBufferArrayNonUniformIndexing    = indexing.shaderStorageBufferArrayNonUniformIndexing;
+            description.vulkan12_features = v12;
+        }
+
+        //a headless device can't present, and doesn't need VK_KHR_swapchain
+        static vk_handle::description::device_desc description(const VkInstance instance, const VkPhysicalDevice phys_device, bool headless = false,
+        feature_profile profile = RELEASE)
         {
             vk_handle::description::device_desc description{};
-            description.enabled_features   = physical_device::get_features(phys_device);
             description.phys_device        = phys_device;
-            determine_queues(instance, description, phys_device, description.device_queues);
+            determine_queues(instance, description, phys_device, description.device_queues, headless);
             //XXX watch out for lack of support here 
-            description.enabled_extensions = physical_device::get_required_extension_names(physical_device::SWAPCHAIN);
+            if(!headless)
+                description.enabled_extensions = physical_device::get_required_extension_names(physical_device::SWAPCHAIN);
+
+            auto indexing = physical_device::get_descriptor_indexing_features(phys_device);
+            if(indexing.has_value() && physical_device::supports_bindless(indexing.value()))
+            {
+                bool core = physical_device::get_properties(phys_device).apiVersion >= VK_API_VERSION_1_2;
+                auto ext  = physical_device::get_required_extension_names(physical_device::DESCRIPTOR_INDEXING);
+                if(core || physical_device::supports_extensions(phys_device, ext))
+                {
+                    VkPhysicalDeviceDescriptorIndexingFeatures enabled{};
+                    enabled.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES;
+                    enabled.runtimeDescriptorArray                        = VK_TRUE;
+                    enabled.descriptorBindingPartiallyBound               = VK_TRUE;
+                    enabled.descriptorBindingStorageBufferUpdateAfterBind = VK_TRUE;
+                    enabled.descriptorBindingSampledImageUpdateAfterBind  = VK_TRUE;
+                    enabled.shaderSampledImageArrayNonUniformIndexing     = VK_TRUE;
+                    enabled.shaderStorageBufferArrayNonUniformIndexing    = indexing.value().shaderStorageBufferArrayNonUniformIndexing;
+                    description.descriptor_indexing_features = enabled;
+                    if(!core)
+                        description.enabled_extensions.insert(description.enabled_extensions.end(), ext.begin(), ext.end());
+                }
+            }
+            if(!description.descriptor_indexing_features.has_value())
+                INFORM("WARNING : descriptor indexing not supported, bindless resources unavailable");
 
+            //optional, callers check device_desc::extension_enabled before pushing descriptors
+            auto push_ext = physical_device::get_required_extension_names(physical_device::PUSH_DESCRIPTOR);
+            if(physical_device::supports_extensions(phys_device, push_ext))
+                description.enabled_extensions.insert(description.enabled_extensions.end(), push_ext.begin(), push_ext.end());
+
+            //optional, pipeline_library_cache_t compiles monolithic pipelines without it
+            auto library = physical_device::get_graphics_pipeline_library_features(phys_device);
+            if(library.has_value() && library.value().graphicsPipelineLibrary)
+            {
+                auto ext = physical_device::get_required_extension_names(physical_device::GRAPHICS_PIPELINE_LIBRARY);
+                description.enabled_extensions.insert(description.enabled_extensions.end(), ext.begin(), ext.end());
+                description.graphics_pipeline_library_features = library;
+            }
+
+            //optional, see extended_dynamic_states() in dynamic_state.h. Only what the engine sets is enabled
+            std::optional<VkPhysicalDeviceExtendedDynamicStateFeaturesEXT>   eds;
+            std::optional<VkPhysicalDeviceExtendedDynamicState2FeaturesEXT> eds2;
+            std::optional<VkPhysicalDeviceExtendedDynamicState3FeaturesEXT> eds3;
+            physical_device::get_extended_dynamic_state_features(phys_device, eds, eds2, eds3);
+            if(eds.has_value() && eds.value().extendedDynamicState)
+            {
+                auto ext = physical_device::get_required_extension_names(physical_device::EXTENDED_DYNAMIC_STATE);
+                description.enabled_extensions.insert(description.enabled_extensions.end(), ext.begin(), ext.end());
+                description.extended_dynamic_state_features = eds;
+            }
+            if(eds2.has_value() && eds2.value().extendedDynamicState2)
+            {
+                auto ext = physical_device::get_required_extension_names(physical_device::EXTENDED_DYNAMIC_STATE_2);
+                description.enabled_extensions.insert(description.enabled_extensions.end(), ext.begin(), ext.end());
+                VkPhysicalDeviceExtendedDynamicState2FeaturesEXT enabled{};
+                enabled.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTENDED_DYNAMIC_STATE_2_FEATURES_EXT;
+                enabled.extendedDynamicState2 = VK_TRUE;
+                description.extended_dynamic_state_2_features = enabled;
+            }
+            if(eds3.has_value() && (eds3.value().extendedDynamicState3PolygonMode || eds3.value().extendedDynamicState3DepthClampEnable))
+            {
+                auto ext = physical_device::get_required_extension_names(physical_device::EXTENDED_DYNAMIC_STATE_3);
+                description.enabled_extensions.insert(description.enabled_extensions.end(), ext.begin(), ext.end());
+                VkPhysicalDeviceExtendedDynamicState3FeaturesEXT enabled{};
+                enabled.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTENDED_DYNAMIC_STATE_3_FEATURES_EXT;
+                enabled.extendedDynamicState3PolygonMode      = eds3.value().extendedDynamicState3PolygonMode;
+                enabled.extendedDynamicState3DepthClampEnable = eds3.value().extendedDynamicState3DepthClampEnable;
+                description.extended_dynamic_state_3_features = enabled;
+            }
+
+            //optional, frames fall back to a renderpass and framebuffers without it
+            auto rendering = physical_device::get_dynamic_rendering_features(phys_device);
+            if(rendering.has_value() && rendering.value().dynamicRendering)
+            {
+                auto ext = physical_device::get_required_extension_names(physical_device::DYNAMIC_RENDERING);
+                description.enabled_extensions.insert(description.enabled_extensions.end(), ext.begin(), ext.end());
+                description.dynamic_rendering_features = rendering;
+            }
+
+            //optional, shader_object_pipeline_t is only used with it
+            auto shader_object = physical_device::get_shader_object_features(phys_device);
+            if(description.dynamic_rendering_features.has_value() && shader_object.has_value() && shader_object.value().shaderObject)
+            {
+                auto ext = physical_device::get_required_extension_names(physical_device::SHADER_OBJECT);
+                description.enabled_extensions.insert(description.enabled_extensions.end(), ext.begin(), ext.end());
+                description.shader_object_features = shader_object;
+            }
+
+            enable_profile_features(description, phys_device, profile);
             return description;
         }
     };
 
     struct swapchain
     {
-        static vk_handle::description::swapchain_desc description(const vk_handle::surface& srf, const vk_handle::device& device, VkSwapchainKHR old_swapchain = VK_NULL_HANDLE)
+        //support caches the surface's formats and present modes between calls, see physical_device::get_surface_features
+        static vk_handle::description::swapchain_desc description(const vk_handle::surface& srf, const vk_handle::device& device,
+        vk_handle::description::surface_support& support, VkSwapchainKHR old_swapchain = VK_NULL_HANDLE)
         {
             vk_handle::description::swapchain_desc desc{};
             desc.surface = srf;
-            desc.features = get_swapchain_features(get_swapchain_support(device.description.phys_device, srf),
-            srf.description.glfw_interface);
+            desc.features = physical_device::get_surface_features(device.description.phys_device, srf, support);
             desc.device_queues = device.description.device_queues;
             desc.parent = device;
             desc.old_swapchain = old_swapchain;
@@ -421,8 +683,7 @@ namespace vk_handle::data_getters
         //determines index in physical device memory properties for this buffer's requirements with a user-defined bitmask
         static uint32_t type_index(uint32_t memory_type_bitmask, VkMemoryRequirements mem_reqs, VkPhysicalDevice phys_dev)
         {
-            VkPhysicalDeviceMemoryProperties mem_properties;
-            vkGetPhysicalDeviceMemoryProperties(phys_dev, &mem_properties);
+            const auto& mem_properties = device_capabilities_t::get(phys_dev).memory_properties;
 
             //from the spec
             /*memoryTypeBits is a bitmask and contains one bit set for every supported memory type for the resource.
@@ -438,7 +699,21 @@ namespace vk_handle::data_getters
             throw std::runtime_error("Failed to find memory index for buffer");
         }
     };
-    VmaVulkanFunctions vma_functions ()
+    struct pipeline_cache
+    {
+        static std::vector<char> get_data(VkDevice device, VkPipelineCache cache)
+        {
+            size_t size = 0;
+            if(vkGetPipelineCacheData(device, cache, &size, nullptr) != VK_SUCCESS)
+                return {};
+            std::vector<char> data(size);
+            if(vkGetPipelineCacheData(device, cache, &size, data.data()) != VK_SUCCESS)
+                return {};
+            data.resize(size);
+            return data;
+        }
+    };
+    inline VmaVulkanFunctions vma_functions ()
     {
         VmaVulkanFunctions vma_funcs;
         vma_funcs.vkBindBufferMemory2KHR = vkBindBufferMemory2KHR;
@@ -19,13 +19,22 @@ namespace vk_handle
     INIT_DECLARATION(VkRenderPass            , renderpass_desc)    
     INIT_DECLARATION(VkShaderModule          , shader_module_desc)
     VkResult init(std::vector<VkPipeline>& handle, std::vector<description::graphics_pipeline_desc> description);
+    VkResult init(std::vector<VkPipeline>& handle, std::vector<description::compute_pipeline_desc> description);
     INIT_DECLARATION(VkPipelineLayout, pipeline_layout_desc)    
+    INIT_DECLARATION(VkPipelineCache , pipeline_cache_desc)
+    INIT_DECLARATION(VkShaderEXT     , shader_object_desc)
+    INIT_DECLARATION(VkDescriptorSetLayout, descriptor_set_layout_desc)
+    INIT_DECLARATION(VkDescriptorPool     , descriptor_pool_desc)
+    INIT_DECLARATION(std::vector<VkDescriptorSet>, descriptor_sets_desc)
+    INIT_DECLARATION(VkDescriptorUpdateTemplate, descriptor_update_template_desc)
     INIT_DECLARATION(VkFramebuffer   , framebuffer_desc)    
     INIT_DECLARATION(VkCommandPool   , cmd_pool_desc)
     INIT_DECLARATION(std::vector<VkCommandBuffer>, cmd_buffers_desc)    
     INIT_DECLARATION(VkSemaphore      , semaphore_desc)    
     INIT_DECLARATION(VkFence          , fence_desc)    
     INIT_DECLARATION(VkBuffer         , buffer_desc&)    
+    INIT_DECLARATION(VkImage          , image_desc&)
+    INIT_DECLARATION(VkSampler        , sampler_desc)
     INIT_DECLARATION(VkDeviceMemory   , memory_desc)
     VkResult init(VmaAllocator& handle, VmaAllocatorCreateInfo description);
 
@@ -42,7 +51,14 @@ namespace vk_handle
     DEST_DECLARATION(VkRenderPass, renderpass_desc)
     DEST_DECLARATION(VkShaderModule, shader_module_desc)
     void destroy(std::vector<VkPipeline> handle, std::vector<description::graphics_pipeline_desc> description);
+    void destroy(std::vector<VkPipeline> handle, std::vector<description::compute_pipeline_desc> description);
     DEST_DECLARATION(VkPipelineLayout, pipeline_layout_desc)
+    DEST_DECLARATION(VkPipelineCache, pipeline_cache_desc)
+    DEST_DECLARATION(VkShaderEXT, shader_object_desc)
+    DEST_DECLARATION(VkDescriptorSetLayout, descriptor_set_layout_desc)
+    DEST_DECLARATION(VkDescriptorPool, descriptor_pool_desc)
+    DEST_DECLARATION(std::vector<VkDescriptorSet>, descriptor_sets_desc)
+    DEST_DECLARATION(VkDescriptorUpdateTemplate, descriptor_update_template_desc)
     DEST_DECLARATION(VkFramebuffer, framebuffer_desc)
     DEST_DECLARATION(VkCommandPool, cmd_pool_desc)
     DEST_DECLARATION(std::vector<VkCommandBuffer>, cmd_buffers_desc)
@@ -50,6 +66,8 @@ namespace vk_handle
     DEST_DECLARATION(VkRenderPass, renderpass_desc)
     DEST_DECLARATION(VkFence, fence_desc)
     DEST_DECLARATION(VkBuffer, buffer_desc)
+    DEST_DECLARATION(VkImage, image_desc)
+    DEST_DECLARATION(VkSampler, sampler_desc)
     DEST_DECLARATION(VkDeviceMemory, memory_desc)
     void destroy(VmaAllocator handle, VmaAllocatorCreateInfo description);
     
@@ -128,13 +146,22 @@ namespace vk_handle
     typedef vk_obj_wrapper<VkRenderPass, description::renderpass_desc> renderpass;
     typedef vk_obj_wrapper<VkShaderModule, description::shader_module_desc> shader_module;
     typedef vk_obj_wrapper<std::vector<VkPipeline>, std::vector<description::graphics_pipeline_desc>> graphics_pipeline;
+    typedef vk_obj_wrapper<std::vector<VkPipeline>, std::vector<description::compute_pipeline_desc>> compute_pipeline;
     typedef vk_obj_wrapper<VkPipelineLayout, description::pipeline_layout_desc> pipeline_layout;
+    typedef vk_obj_wrapper<VkPipelineCache, description::pipeline_cache_desc> pipeline_cache;
+    typedef vk_obj_wrapper<VkShaderEXT, description::shader_object_desc> shader_object;
+    typedef vk_obj_wrapper<VkDescriptorSetLayout, description::descriptor_set_layout_desc> descriptor_set_layout;
+    typedef vk_obj_wrapper<VkDescriptorPool, description::descriptor_pool_desc> descriptor_pool;
+    typedef vk_obj_wrapper<std::vector<VkDescriptorSet>, description::descriptor_sets_desc> descriptor_sets;
+    typedef vk_obj_wrapper<VkDescriptorUpdateTemplate, description::descriptor_update_template_desc> descriptor_update_template;
     typedef vk_obj_wrapper<VkFramebuffer, description::framebuffer_desc> framebuffer;
     typedef vk_obj_wrapper<VkCommandPool, description::cmd_pool_desc> cmd_pool;
     typedef vk_obj_wrapper<std::vector<VkCommandBuffer>, description::cmd_buffers_desc> cmd_buffers;
     typedef vk_obj_wrapper<VkSemaphore, description::semaphore_desc> semaphore;
     typedef vk_obj_wrapper<VkFence, description::fence_desc> fence;
     typedef vk_obj_wrapper<VkBuffer, description::buffer_desc> buffer;
+    typedef vk_obj_wrapper<VkImage, description::image_desc> image;
+    typedef vk_obj_wrapper<VkSampler, description::sampler_desc> sampler;
     typedef vk_obj_wrapper<VkDeviceMemory, description::memory_desc> memory;
     typedef vk_obj_wrapper<VmaAllocator, VmaAllocatorCreateInfo> allocator;
 }
\ No newline at end of file
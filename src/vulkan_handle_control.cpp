@@ -61,11 +61,52 @@ VkResult vk_handle::init(std::vector<VkPipeline>& handle, std::vector<vk_handle:
     return vkCreateGraphicsPipelines(desc[0].parent, desc[0].pipeline_cache.value_or(VK_NULL_HANDLE), desc.size(), infos.data(),
     nullptr, handle.data());
 }
+VkResult vk_handle::init(std::vector<VkPipeline>& handle, std::vector<vk_handle::description::compute_pipeline_desc> desc)
+{
+    handle.resize(desc.size());
+    std::vector<VkComputePipelineCreateInfo> infos;
+    infos.reserve(desc.size());
+    for(auto& d : desc)
+        infos.push_back(d.get_create_info());
+    return vkCreateComputePipelines(desc[0].parent, desc[0].pipeline_cache.value_or(VK_NULL_HANDLE), desc.size(), infos.data(),
+    nullptr, handle.data());
+}
 VkResult vk_handle::init(VkPipelineLayout& handle, description::pipeline_layout_desc desc)
 {
     auto info = desc.get_create_info();
     return vkCreatePipelineLayout(desc.parent, &info, nullptr, &handle);
 }
+VkResult vk_handle::init(VkPipelineCache& handle, description::pipeline_cache_desc desc)
+{
+    auto info = desc.get_create_info();
+    return vkCreatePipelineCache(desc.parent, &info, nullptr, &handle);
+}
+VkResult vk_handle::init(VkShaderEXT& handle, description::shader_object_desc desc)
+{
+    auto info = desc.get_create_info();
+    return vkCreateShadersEXT(desc.parent, 1, &info, nullptr, &handle);
+}
+VkResult vk_handle::init(VkDescriptorSetLayout& handle, description::descriptor_set_layout_desc desc)
+{
+    auto info = desc.get_create_info();
+    return vkCreateDescriptorSetLayout(desc.parent, &info, nullptr, &handle);
+}
+VkResult vk_handle::init(VkDescriptorPool& handle, description::descriptor_pool_desc desc)
+{
+    auto info = desc.get_create_info();
+    return vkCreateDescriptorPool(desc.parent, &info, nullptr, &handle);
+}
+VkResult vk_handle::init(std::vector<VkDescriptorSet>& handle, description::descriptor_sets_desc desc)
+{
+    auto info = desc.get_alloc_info();
+    handle.resize(desc.layouts.size());
+    return vkAllocateDescriptorSets(desc.parent, &info, handle.data());
+}
+VkResult vk_handle::init(VkDescriptorUpdateTemplate& handle, description::descriptor_update_template_desc desc)
+{
+    auto info = desc.get_create_info();
+    return vkCreateDescriptorUpdateTemplate(desc.parent, &info, nullptr, &handle);
+}
 VkResult vk_handle::init(VkFramebuffer& handle, description::framebuffer_desc desc)
 {
     auto info = desc.get_create_info();
@@ -98,6 +139,17 @@ VkResult vk_handle::init(VkBuffer& handle, description::buffer_desc& desc)
     return vmaCreateBuffer(desc.allocator, &info, &desc.alloc_info,
     &handle, &desc.allocation_object, nullptr);
 }
+VkResult vk_handle::init(VkImage& handle, description::image_desc& desc)
+{
+    auto info = desc.get_create_info();
+    return vmaCreateImage(desc.allocator, &info, &desc.alloc_info,
+    &handle, &desc.allocation_object, nullptr);
+}
+VkResult vk_handle::init(VkSampler& handle, description::sampler_desc desc)
+{
+    auto info = desc.get_create_info();
+    return vkCreateSampler(desc.parent, &info, nullptr, &handle);
+}
 VkResult vk_handle::init(VkDeviceMemory& handle, description::memory_desc desc)
 {
     auto info = desc.get_info();
@@ -157,10 +209,47 @@ void vk_handle::destroy(std::vector<VkPipeline> handle, std::vector<description:
     for(size_t i = 0; i < handle.size(); ++i)
         vkDestroyPipeline(desc[i].parent, handle[i], nullptr);
 }
+void vk_handle::destroy(std::vector<VkPipeline> handle, std::vector<description::compute_pipeline_desc> desc)
+{
+    if(desc.empty())
+        INFORM_ERR("WARNING : destroying compute pipeline with 0 descriptions!");
+    if(desc.size() != handle.size())
+        INFORM_ERR("WARNING : unequal number of compute pipelines and descriptions!");
+    for(size_t i = 0; i < handle.size(); ++i)
+        vkDestroyPipeline(desc[i].parent, handle[i], nullptr);
+}
 void vk_handle::destroy(VkPipelineLayout handle, description::pipeline_layout_desc desc)
 {
     vkDestroyPipelineLayout(desc.parent, handle, nullptr);
 }
+void vk_handle::destroy(VkPipelineCache handle, description::pipeline_cache_desc desc)
+{
+    vkDestroyPipelineCache(desc.parent, handle, nullptr);
+}
+void vk_handle::destroy(VkShaderEXT handle, description::shader_object_desc desc)
+{
+    vkDestroyShaderEXT(desc.parent, handle, nullptr);
+}
+void vk_handle::destroy(VkDescriptorSetLayout handle, description::descriptor_set_layout_desc desc)
+{
+    vkDestroyDescriptorSetLayout(desc.parent, handle, nullptr);
+}
+void vk_handle::destroy(VkDescriptorPool handle, description::descriptor_pool_desc desc)
+{
+    vkDestroyDescriptorPool(desc.parent, handle, nullptr);
+}
+void vk_handle::destroy(std::vector<VkDescriptorSet> handle, description::descriptor_sets_desc desc)
+{
+    if(desc.layouts.size() != handle.size())
+        INFORM_ERR("WARNING : descriptor set count not equal to layout count!");
+    //otherwise resetting or destroying the pool takes care of it
+    if(desc.free_individually)
+        vkFreeDescriptorSets(desc.parent, desc.pool, static_cast<uint32_t>(handle.size()), handle.data());
+}
+void vk_handle::destroy(VkDescriptorUpdateTemplate handle, description::descriptor_update_template_desc desc)
+{
+    vkDestroyDescriptorUpdateTemplate(desc.parent, handle, nullptr);
+}
 void vk_handle::destroy(VkFramebuffer handle, description::framebuffer_desc desc)
 {
     vkDestroyFramebuffer(desc.parent, handle, nullptr);
@@ -187,6 +276,14 @@ void vk_handle::destroy(VkBuffer handle, description::buffer_desc desc)
 {
     vmaDestroyBuffer(desc.allocator, handle, desc.allocation_object);
 }
+void vk_handle::destroy(VkImage handle, description::image_desc desc)
+{
+    vmaDestroyImage(desc.allocator, handle, desc.allocation_object);
+}
+void vk_handle::destroy(VkSampler handle, description::sampler_desc desc)
+{
+    vkDestroySampler(desc.parent, handle, nullptr);
+}
 void vk_handle::destroy(VkDeviceMemory handle, description::memory_desc desc)
 {
     vkFreeMemory(desc.parent, handle, nullptr);
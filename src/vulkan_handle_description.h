@@ -10,6 +10,8 @@
 #include <stdexcept>
 #include <string>
 #include <map>
+#include <span>
+#include <algorithm>
 
 #include "debug.h"
 
@@ -129,12 +131,36 @@ namespace vk_handle
             std::vector<device_queue>     device_queues{};
             std::vector<std::string> enabled_extensions{};
             VkPhysicalDeviceFeatures   enabled_features{};
+            //set when the device and the instance are at least 1.2, see data_getters::device::feature_profile
+            std::optional<VkPhysicalDeviceVulkan11Features> vulkan11_features;
+            std::optional<VkPhysicalDeviceVulkan12Features> vulkan12_features;
             
             queue_desc graphics_queue{};
             queue_desc transfer_queue{};
             queue_desc  compute_queue{};
             queue_desc  present_queue{};
 
+            //set if the device supports the bindless subset of descriptor indexing
+            std::optional<VkPhysicalDeviceDescriptorIndexingFeatures> descriptor_indexing_features;
+            //set if VK_EXT_graphics_pipeline_library is enabled
+            std::optional<VkPhysicalDeviceGraphicsPipelineLibraryFeaturesEXT> graphics_pipeline_library_features;
+            //set if VK_KHR_dynamic_rendering is enabled
+            std::optional<VkPhysicalDeviceDynamicRenderingFeaturesKHR>         dynamic_rendering_features;
+            //set if VK_EXT_shader_object is enabled, only ever together with dynamic rendering
+            std::optional<VkPhysicalDeviceShaderObjectFeaturesEXT>                 shader_object_features;
+            //set for each VK_EXT_extended_dynamic_state extension that is enabled
+            std::optional<VkPhysicalDeviceExtendedDynamicStateFeaturesEXT>     extended_dynamic_state_features;
+            std::optional<VkPhysicalDeviceExtendedDynamicState2FeaturesEXT>  extended_dynamic_state_2_features;
+            std::optional<VkPhysicalDeviceExtendedDynamicState3FeaturesEXT>  extended_dynamic_state_3_features;
+
+            bool extension_enabled(const char* name) const
+            {
+                for(const auto& ext : enabled_extensions)
+                    if(ext == name)
+                        return true;
+                return false;
+            }
+
             VkDeviceCreateInfo get_create_info()
             {
                 VkDeviceCreateInfo info{};
@@ -165,16 +191,76 @@ namespace vk_handle
 
                 info.enabledLayerCount = 0;
 
-                info.pEnabledFeatures = &enabled_features;
-
                 info.queueCreateInfoCount = static_cast<uint32_t>(queue_create_infos.size());
                 info.pQueueCreateInfos    = queue_create_infos.data();
 
+                void* chain = nullptr;
+                //the per version structs can't be chained next to the structs they absorbed, whoever fills them folds those in
+                bool versioned = vulkan11_features.has_value() || vulkan12_features.has_value();
+                if(vulkan11_features.has_value())
+                {
+                    vulkan11_features.value().pNext = chain;
+                    chain = &vulkan11_features.value();
+                }
+                if(vulkan12_features.has_value())
+                {
+                    vulkan12_features.value().pNext = chain;
+                    chain = &vulkan12_features.value();
+                }
+                if(descriptor_indexing_features.has_value() && !vulkan12_features.has_value())
+                {
+                    descriptor_indexing_features.value().pNext = chain;
+                    chain = &descriptor_indexing_features.value();
+                }
+                if(graphics_pipeline_library_features.has_value())
+                {
+                    graphics_pipeline_library_features.value().pNext = chain;
+                    chain = &graphics_pipeline_library_features.value();
+                }
+                if(dynamic_rendering_features.has_value())
+                {
+                    dynamic_rendering_features.value().pNext = chain;
+                    chain = &dynamic_rendering_features.value();
+                }
+                if(shader_object_features.has_value())
+                {
+                    shader_object_features.value().pNext = chain;
+                    chain = &shader_object_features.value();
+                }
+                if(extended_dynamic_state_features.has_value())
+                {
+                    extended_dynamic_state_features.value().pNext = chain;
+                    chain = &extended_dynamic_state_features.value();
+                }
+                if(extended_dynamic_state_2_features.has_value())
+                {
+                    extended_dynamic_state_2_features.value().pNext = chain;
+                    chain = &extended_dynamic_state_2_features.value();
+                }
+                if(extended_dynamic_state_3_features.has_value())
+                {
+                    extended_dynamic_state_3_features.value().pNext = chain;
+                    chain = &extended_dynamic_state_3_features.value();
+                }
+                //the core features travel in the chain too once there is one
+                if(versioned)
+                {
+                    features2 = VkPhysicalDeviceFeatures2{};
+                    features2.sType    = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+                    features2.features = enabled_features;
+                    features2.pNext    = chain;
+                    chain = &features2;
+                }
+                else
+                    info.pEnabledFeatures = &enabled_features;
+                info.pNext = chain;
+
                 return info;
             }
         private:
             std::vector<const char*> extension_names;
             std::vector<VkDeviceQueueCreateInfo> queue_create_infos;
+            VkPhysicalDeviceFeatures2                      features2{};
         };
         struct surface_support
         {
@@ -420,11 +506,34 @@ namespace vk_handle
             VkLogicOp logic_op;
             std::vector<VkPipelineColorBlendAttachmentState> attachment_states;
         };
+        //attachment formats for pipelines used with VK_KHR_dynamic_rendering, in place of a renderpass
+        struct rendering_desc
+        {
+            std::vector<VkFormat>    color_formats{};
+            std::optional<VkFormat>   depth_format;
+            std::optional<VkFormat> stencil_format;
+            uint32_t                   view_mask = 0;
+            VkPipelineRenderingCreateInfoKHR get_info()
+            {
+                VkPipelineRenderingCreateInfoKHR info{};
+                info.sType = VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO_KHR;
+                info.viewMask = view_mask;
+                info.colorAttachmentCount    = static_cast<uint32_t>(color_formats.size());
+                info.pColorAttachmentFormats = color_formats.data();
+                info.depthAttachmentFormat   = depth_format.value_or(VK_FORMAT_UNDEFINED);
+                info.stencilAttachmentFormat = stencil_format.value_or(VK_FORMAT_UNDEFINED);
+                return info;
+            }
+        };
         struct dynamic_state_desc
         {
             dynamic_state_desc(){}
             dynamic_state_desc(std::vector<VkDynamicState> dynamic_state_list){this->dynamic_state_list = dynamic_state_list;}
             std::vector<VkDynamicState> dynamic_state_list;
+            bool is_dynamic(VkDynamicState state) const
+            {
+                return std::find(dynamic_state_list.begin(), dynamic_state_list.end(), state) != dynamic_state_list.end();
+            }
             VkPipelineDynamicStateCreateInfo get_info()
             {
                 VkPipelineDynamicStateCreateInfo info{};
@@ -440,16 +549,24 @@ namespace vk_handle
         {
             std::vector<VkVertexInputBindingDescription>   binding_descriptions;
             std::vector<VkVertexInputAttributeDescription> attrib_descriptions;
+            //used instead of the vectors when set, e.g. to constexpr arrays from vertex_layout.h. Must outlive pipeline creation
+            std::span<const VkVertexInputBindingDescription>   static_binding_descriptions;
+            std::span<const VkVertexInputAttributeDescription> static_attrib_descriptions;
             std::optional<VkPipelineVertexInputStateCreateFlags> flags;
             VkPipelineVertexInputStateCreateInfo get_info()
             {
+                std::span<const VkVertexInputBindingDescription> bindings = static_binding_descriptions.empty() ? 
+                std::span<const VkVertexInputBindingDescription>(binding_descriptions) : static_binding_descriptions;
+                std::span<const VkVertexInputAttributeDescription> attribs = static_attrib_descriptions.empty() ? 
+                std::span<const VkVertexInputAttributeDescription>(attrib_descriptions) : static_attrib_descriptions;
+
                 VkPipelineVertexInputStateCreateInfo info{};
                 info.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
                 info.flags = flags.value_or(0);
-                info.vertexBindingDescriptionCount   = static_cast<uint32_t>(binding_descriptions.size());
-                info.pVertexBindingDescriptions      = binding_descriptions.data();
-                info.vertexAttributeDescriptionCount = static_cast<uint32_t>(attrib_descriptions.size());
-                info.pVertexAttributeDescriptions    = attrib_descriptions.data();
+                info.vertexBindingDescriptionCount   = static_cast<uint32_t>(bindings.size());
+                info.pVertexBindingDescriptions      = bindings.data();
+                info.vertexAttributeDescriptionCount = static_cast<uint32_t>(attribs.size());
+                info.pVertexAttributeDescriptions    = attribs.data();
                 info.pNext = nullptr;
                 return info;
             }
@@ -514,12 +631,19 @@ namespace vk_handle
         };
         struct depth_stencil_desc
         {
+            VkBool32    depth_test_enable  = VK_FALSE;
+            VkBool32    depth_write_enable = VK_FALSE;
+            VkCompareOp depth_compare_op   = VK_COMPARE_OP_LESS;
             VkPipelineDepthStencilStateCreateInfo get_depth_stencil_info()
             {
                 VkPipelineDepthStencilStateCreateInfo info{};
                 info.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
                 info.pNext = nullptr;
                 info.flags = 0;
+                info.depthTestEnable  = depth_test_enable;
+                info.depthWriteEnable = depth_write_enable;
+                info.depthCompareOp   = depth_compare_op;
+                info.maxDepthBounds   = 1.0f;
                 return info;
             }
         };
@@ -548,6 +672,8 @@ namespace vk_handle
             VkPipelineLayout              pipeline_layout;
             VkRenderPass                       renderpass;
             uint32_t                        subpass_index;
+            //VK_KHR_dynamic_rendering : set instead of renderpass, which must then be VK_NULL_HANDLE
+            std::optional<rendering_desc>           rendering;
 
             std::optional<VkPipelineCache>                   pipeline_cache;
             std::optional<depth_stencil_desc>            depth_stencil_info;
@@ -559,14 +685,54 @@ namespace vk_handle
             rasterization_desc                           rasterization_info;
             multisample_desc                               multisample_info;
             color_blend_desc                               color_blend_info;
+
+            std::optional<VkPipelineCreateFlags>                      flags;
+            //VK_EXT_graphics_pipeline_library : only build these parts, as a library. State of other parts is ignored
+            std::optional<VkGraphicsPipelineLibraryFlagsEXT>  library_parts;
+            //VK_EXT_graphics_pipeline_library : link these libraries instead. Only parent, pipeline_layout and flags are used
+            std::vector<VkPipeline>                               libraries{};
+
             VkGraphicsPipelineCreateInfo get_create_info()
             {
                 VkGraphicsPipelineCreateInfo pipeline_info{};
                 pipeline_info.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
-                pipeline_info.stageCount = static_cast<uint32_t>(shader_stages_info.size());
-                for(auto shader : shader_stages_info)
-                    shader_stages_state.push_back(shader.get_shader_stage_info());
+                pipeline_info.flags = flags.value_or(0);
+                if(!libraries.empty())
+                {
+                    link_info = VkPipelineLibraryCreateInfoKHR{};
+                    link_info.sType = VK_STRUCTURE_TYPE_PIPELINE_LIBRARY_CREATE_INFO_KHR;
+                    link_info.libraryCount = static_cast<uint32_t>(libraries.size());
+                    link_info.pLibraries   = libraries.data();
+                    pipeline_info.pNext  = &link_info;
+                    pipeline_info.layout = pipeline_layout;
+                    return pipeline_info;
+                }
+                VkGraphicsPipelineLibraryFlagsEXT parts = library_parts.value_or(
+                VK_GRAPHICS_PIPELINE_LIBRARY_VERTEX_INPUT_INTERFACE_BIT_EXT | VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT |
+                VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT | VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_OUTPUT_INTERFACE_BIT_EXT);
+                bool vertex_input    = parts & VK_GRAPHICS_PIPELINE_LIBRARY_VERTEX_INPUT_INTERFACE_BIT_EXT;
+                bool pre_raster      = parts & VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT;
+                bool fragment        = parts & VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT;
+                bool fragment_output = parts & VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_OUTPUT_INTERFACE_BIT_EXT;
+                if(library_parts.has_value())
+                {
+                    library_info = VkGraphicsPipelineLibraryCreateInfoEXT{};
+                    library_info.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_LIBRARY_CREATE_INFO_EXT;
+                    library_info.flags = parts;
+                    pipeline_info.pNext = &library_info;
+                    //keep what an optimized link needs
+                    pipeline_info.flags |= VK_PIPELINE_CREATE_LIBRARY_BIT_KHR | VK_PIPELINE_CREATE_RETAIN_LINK_TIME_OPTIMIZATION_INFO_BIT_EXT;
+                }
 
+                //by reference, the stage info points into specialization_info
+                shader_stages_state.clear();
+                for(auto& shader : shader_stages_info)
+                {
+                    bool is_fragment = shader.stage == VK_SHADER_STAGE_FRAGMENT_BIT;
+                    if((is_fragment && fragment) || (!is_fragment && pre_raster))
+                        shader_stages_state.push_back(shader.get_shader_stage_info());
+                }
+                pipeline_info.stageCount = static_cast<uint32_t>(shader_stages_state.size());
                 pipeline_info.pStages = shader_stages_state.data();
 
                 vertex_input_state = vertex_input_info.get_info();
@@ -602,9 +768,34 @@ namespace vk_handle
                 pipeline_info.renderPass =      renderpass;
                 pipeline_info.subpass    =   subpass_index;
 
+                if(!vertex_input)
+                    pipeline_info.pVertexInputState = nullptr, pipeline_info.pInputAssemblyState = nullptr;
+                if(!pre_raster)
+                    pipeline_info.pViewportState = nullptr, pipeline_info.pRasterizationState = nullptr;
+                if(!fragment)
+                    pipeline_info.pDepthStencilState = nullptr;
+                if(!fragment && !fragment_output)
+                    pipeline_info.pMultisampleState = nullptr;
+                if(!fragment_output)
+                    pipeline_info.pColorBlendState = nullptr;
+                if(!pre_raster && !fragment)
+                    pipeline_info.layout = VK_NULL_HANDLE;
+                if(!pre_raster && !fragment && !fragment_output)
+                    pipeline_info.renderPass = VK_NULL_HANDLE;
+
+                if(rendering.has_value())
+                {
+                    rendering_state = rendering.value().get_info();
+                    rendering_state.pNext = pipeline_info.pNext;
+                    pipeline_info.pNext   = &rendering_state;
+                }
+
                 return pipeline_info;
             }
         private:
+            VkGraphicsPipelineLibraryCreateInfoEXT library_info;
+            VkPipelineLibraryCreateInfoKHR            link_info;
+            VkPipelineRenderingCreateInfoKHR    rendering_state;
             std::vector<VkPipelineShaderStageCreateInfo> shader_stages_state;
             VkPipelineDepthStencilStateCreateInfo depth_stencil_state;
             VkPipelineRasterizationStateCreateInfo raster_state;
@@ -615,17 +806,216 @@ namespace vk_handle
             VkPipelineDynamicStateCreateInfo     dynamic_state;
             VkPipelineMultisampleStateCreateInfo multisample_state;
         };
+        struct compute_pipeline_desc
+        {
+            VkDevice parent;
+
+            VkPipelineLayout            pipeline_layout;
+            shader_stage_desc         shader_stage_info;
+
+            std::optional<VkPipelineCache>       pipeline_cache;
+            std::optional<VkPipelineCreateFlags>          flags;
+            VkComputePipelineCreateInfo get_create_info()
+            {
+                VkComputePipelineCreateInfo info{};
+                info.sType  = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+                info.pNext  = nullptr;
+                info.flags  = flags.value_or(0);
+                info.stage  = shader_stage_info.get_shader_stage_info();
+                info.layout = pipeline_layout;
+                return info;
+            }
+        };
         struct pipeline_layout_desc
         {
             VkDevice parent;
 
+            std::vector<VkDescriptorSetLayout> set_layouts{};
+            std::vector<VkPushConstantRange> push_constant_ranges{};
+            //index into set_layouts of the (at most one) layout created with push_descriptor set
+            std::optional<uint32_t> push_descriptor_set;
+
             VkPipelineLayoutCreateInfo get_create_info()
             {
                 VkPipelineLayoutCreateInfo info{};
                 info.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+                info.setLayoutCount = static_cast<uint32_t>(set_layouts.size());
+                info.pSetLayouts    = set_layouts.data();
+                info.pushConstantRangeCount = static_cast<uint32_t>(push_constant_ranges.size());
+                info.pPushConstantRanges    = push_constant_ranges.data();
                 return info;        
             }
         };
+        //VK_EXT_shader_object : a shader that is bound on its own, all other state is set while recording
+        struct shader_object_desc
+        {
+            VkDevice parent;
+
+            VkShaderStageFlagBits stage;
+            //stages that may be bound after this one, e.g. fragment for a vertex shader
+            VkShaderStageFlags next_stage = 0;
+            const char* entry_point_name = "main";
+
+            std::vector<char> byte_code;
+            //must match the pipeline layout the shader's descriptors and push constants are bound with
+            std::vector<VkDescriptorSetLayout> set_layouts{};
+            std::vector<VkPushConstantRange>   push_constant_ranges{};
+            std::optional<VkSpecializationInfo> specialization_info;
+            std::optional<VkShaderCreateFlagsEXT> flags;
+
+            shader_object_desc(){}
+            //same byte code and stage as the module
+            shader_object_desc(const shader_module_desc& module, const pipeline_layout_desc& layout, VkShaderStageFlags next_stage = 0) :
+            parent(module.parent), stage(module.stage), next_stage(next_stage), entry_point_name(module.entry_point_name),
+            byte_code(module.byte_code), set_layouts(layout.set_layouts), push_constant_ranges(layout.push_constant_ranges)
+            {
+            }
+
+            VkShaderCreateInfoEXT get_create_info()
+            {
+                VkShaderCreateInfoEXT info{};
+                info.sType     = VK_STRUCTURE_TYPE_SHADER_CREATE_INFO_EXT;
+                info.flags     = flags.value_or(0);
+                info.stage     = stage;
+                info.nextStage = next_stage;
+                info.codeType  = VK_SHADER_CODE_TYPE_SPIRV_EXT;
+                info.codeSize  = byte_code.size();
+                info.pCode     = byte_code.data();
+                info.pName     = entry_point_name;
+                info.setLayoutCount = static_cast<uint32_t>(set_layouts.size());
+                info.pSetLayouts    = set_layouts.data();
+                info.pushConstantRangeCount = static_cast<uint32_t>(push_constant_ranges.size());
+                info.pPushConstantRanges    = push_constant_ranges.data();
+                info.pSpecializationInfo    = specialization_info.has_value() ? &specialization_info.value() : nullptr;
+                return info;
+            }
+        };
+        struct pipeline_cache_desc
+        {
+            VkDevice parent;
+
+            //blob from a previous vkGetPipelineCacheData, the driver ignores it if it doesn't match the device
+            std::vector<char> initial_data{};
+            std::optional<VkPipelineCacheCreateFlags> flags;
+            VkPipelineCacheCreateInfo get_create_info()
+            {
+                VkPipelineCacheCreateInfo info{};
+                info.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+                info.flags = flags.value_or(0);
+                info.initialDataSize = initial_data.size();
+                info.pInitialData    = initial_data.empty() ? nullptr : initial_data.data();
+                return info;
+            }
+        };
+        struct descriptor_set_layout_desc
+        {
+            VkDevice parent;
+
+            std::vector<VkDescriptorSetLayoutBinding> bindings{};
+            std::optional<VkDescriptorSetLayoutCreateFlags> flags;
+            //either empty or one entry per binding
+            std::vector<VkDescriptorBindingFlags> binding_flags{};
+            //descriptors are pushed into the command buffer instead of allocated from a pool. Requires VK_KHR_push_descriptor
+            bool push_descriptor = false;
+
+            VkDescriptorSetLayoutCreateInfo get_create_info()
+            {
+                VkDescriptorSetLayoutCreateInfo info{};
+                info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+                info.pNext = nullptr;
+                info.flags = flags.value_or(0);
+                if(push_descriptor)
+                    info.flags |= VK_DESCRIPTOR_SET_LAYOUT_CREATE_PUSH_DESCRIPTOR_BIT_KHR;
+                info.bindingCount = static_cast<uint32_t>(bindings.size());
+                info.pBindings    = bindings.data();
+
+                if(!binding_flags.empty())
+                {
+                    if(binding_flags.size() != bindings.size())
+                        INFORM_ERR("WARNING : binding flag count not equal to binding count!");
+                    binding_flags_info = VkDescriptorSetLayoutBindingFlagsCreateInfo{};
+                    binding_flags_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO;
+                    binding_flags_info.bindingCount  = static_cast<uint32_t>(binding_flags.size());
+                    binding_flags_info.pBindingFlags = binding_flags.data();
+                    info.pNext = &binding_flags_info;
+                }
+                return info;
+            }
+        private:
+            VkDescriptorSetLayoutBindingFlagsCreateInfo binding_flags_info{};
+        };
+        struct descriptor_pool_desc
+        {
+            VkDevice parent;
+
+            uint32_t max_sets;
+            std::vector<VkDescriptorPoolSize> pool_sizes{};
+            std::optional<VkDescriptorPoolCreateFlags> flags;
+
+            VkDescriptorPoolCreateInfo get_create_info()
+            {
+                VkDescriptorPoolCreateInfo info{};
+                info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+                info.pNext = nullptr;
+                info.flags = flags.value_or(0);
+                info.maxSets       = max_sets;
+                info.poolSizeCount = static_cast<uint32_t>(pool_sizes.size());
+                info.pPoolSizes    = pool_sizes.data();
+                return info;
+            }
+        };
+        struct descriptor_sets_desc
+        {
+            VkDevice parent;
+
+            VkDescriptorPool pool = VK_NULL_HANDLE;
+            std::vector<VkDescriptorSetLayout> layouts{};
+            //only valid if the pool was created with VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT.
+            //otherwise the sets are reclaimed when the pool is reset or destroyed
+            bool free_individually = false;
+
+            VkDescriptorSetAllocateInfo get_alloc_info()
+            {
+                VkDescriptorSetAllocateInfo info{};
+                info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+                info.pNext = nullptr;
+                info.descriptorPool     = pool;
+                info.descriptorSetCount = static_cast<uint32_t>(layouts.size());
+                info.pSetLayouts        = layouts.data();
+                return info;
+            }
+        };
+        struct descriptor_update_template_desc
+        {
+            VkDevice parent;
+
+            std::vector<VkDescriptorUpdateTemplateEntry> entries{};
+            std::optional<VkDescriptorUpdateTemplateType> template_type;
+
+            //for VK_DESCRIPTOR_UPDATE_TEMPLATE_TYPE_DESCRIPTOR_SET
+            VkDescriptorSetLayout descriptor_set_layout = VK_NULL_HANDLE;
+
+            //for VK_DESCRIPTOR_UPDATE_TEMPLATE_TYPE_PUSH_DESCRIPTORS_KHR
+            std::optional<VkPipelineBindPoint> bind_point;
+            VkPipelineLayout pipeline_layout = VK_NULL_HANDLE;
+            uint32_t set = 0;
+
+            VkDescriptorUpdateTemplateCreateInfo get_create_info()
+            {
+                VkDescriptorUpdateTemplateCreateInfo info{};
+                info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_UPDATE_TEMPLATE_CREATE_INFO;
+                info.pNext = nullptr;
+                info.flags = 0;
+                info.descriptorUpdateEntryCount = static_cast<uint32_t>(entries.size());
+                info.pDescriptorUpdateEntries   = entries.data();
+                info.templateType        = template_type.value_or(VK_DESCRIPTOR_UPDATE_TEMPLATE_TYPE_DESCRIPTOR_SET);
+                info.descriptorSetLayout = descriptor_set_layout;
+                info.pipelineBindPoint   = bind_point.value_or(VK_PIPELINE_BIND_POINT_GRAPHICS);
+                info.pipelineLayout      = pipeline_layout;
+                info.set                 = set;
+                return info;
+            }
+        };
         struct framebuffer_desc
         {
             VkDevice parent;
@@ -753,6 +1143,86 @@ namespace vk_handle
                 return create_info;
             }
         };
+        struct image_desc
+        {
+            VkDevice parent;
+
+            VmaAllocator allocator;
+            VmaAllocationCreateInfo alloc_info{};
+
+            VkFormat          format;
+            VkExtent3D        extent;
+            VkImageUsageFlags  usage;
+
+            std::vector<uint32_t> queue_fam_indices;
+
+            std::optional<VkImageType>               image_type;
+            std::optional<uint32_t>                  mip_levels;
+            std::optional<uint32_t>                array_layers;
+            std::optional<VkSampleCountFlagBits>        samples;
+            std::optional<VkImageTiling>                 tiling;
+            std::optional<VkImageLayout>         initial_layout;
+            std::optional<VkSharingMode>           sharing_mode;
+            std::optional<VkImageCreateFlags>             flags;
+
+            //we store this object here just for VMA. Don't mess with this.
+            VmaAllocation allocation_object;
+
+            VkImageCreateInfo get_create_info()
+            {
+                VkImageCreateInfo create_info{};
+                create_info.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+                create_info.pNext = nullptr;
+                create_info.flags = flags.value_or(0);
+
+                create_info.imageType     = image_type.value_or(VK_IMAGE_TYPE_2D);
+                create_info.format        = format;
+                create_info.extent        = extent;
+                create_info.mipLevels     = mip_levels.value_or(1);
+                create_info.arrayLayers   = array_layers.value_or(1);
+                create_info.samples       = samples.value_or(VK_SAMPLE_COUNT_1_BIT);
+                create_info.tiling        = tiling.value_or(VK_IMAGE_TILING_OPTIMAL);
+                create_info.usage         = usage;
+                create_info.initialLayout = initial_layout.value_or(VK_IMAGE_LAYOUT_UNDEFINED);
+
+                create_info.queueFamilyIndexCount = static_cast<uint32_t>(queue_fam_indices.size());
+                create_info.pQueueFamilyIndices   = queue_fam_indices.data();
+
+                create_info.sharingMode = sharing_mode.value_or(create_info.queueFamilyIndexCount > 1 ? VK_SHARING_MODE_CONCURRENT : VK_SHARING_MODE_EXCLUSIVE);
+
+                return create_info;
+            }
+        };
+        struct sampler_desc
+        {
+            VkDevice parent;
+
+            std::optional<VkFilter>                 mag_filter;
+            std::optional<VkFilter>                 min_filter;
+            std::optional<VkSamplerMipmapMode>     mipmap_mode;
+            std::optional<VkSamplerAddressMode>   address_mode;
+            std::optional<float>            max_anisotropy;
+            std::optional<float>                   max_lod;
+
+            VkSamplerCreateInfo get_create_info()
+            {
+                VkSamplerCreateInfo info{};
+                info.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+                info.pNext = nullptr;
+                info.magFilter    = mag_filter.value_or(VK_FILTER_LINEAR);
+                info.minFilter    = min_filter.value_or(VK_FILTER_LINEAR);
+                info.mipmapMode   = mipmap_mode.value_or(VK_SAMPLER_MIPMAP_MODE_LINEAR);
+                info.addressModeU = address_mode.value_or(VK_SAMPLER_ADDRESS_MODE_REPEAT);
+                info.addressModeV = info.addressModeU;
+                info.addressModeW = info.addressModeU;
+                info.anisotropyEnable = max_anisotropy.has_value() ? VK_TRUE : VK_FALSE;
+                info.maxAnisotropy    = max_anisotropy.value_or(1.0f);
+                info.minLod = 0.0f;
+                info.maxLod = max_lod.value_or(VK_LOD_CLAMP_NONE);
+                info.borderColor = VK_BORDER_COLOR_INT_OPAQUE_BLACK;
+                return info;
+            }
+        };
         struct memory_desc
         {
             VkDevice parent;
@@ -33,13 +33,21 @@ namespace vk_handle
     CONST_SHARED_DECL(image_view)
     CONST_SHARED_DECL(renderpass)
     CONST_SHARED_DECL(framebuffer)
+    CONST_SHARED_DECL(descriptor_set_layout)
+    CONST_SHARED_DECL(descriptor_pool)
+    CONST_SHARED_DECL(descriptor_update_template)
     CONST_SHARED_DECL(shader_module)
     CONST_SHARED_DECL(graphics_pipeline)
+    CONST_SHARED_DECL(compute_pipeline)
+    CONST_SHARED_DECL(pipeline_cache)
+    CONST_SHARED_DECL(shader_object)
     CONST_SHARED_DECL(cmd_pool)
     CONST_SHARED_DECL(cmd_buffers)
     CONST_SHARED_DECL(semaphore)
     CONST_SHARED_DECL(fence)
     CONST_SHARED_DECL(buffer)
+    CONST_SHARED_DECL(image)
+    CONST_SHARED_DECL(sampler)
 }
 
 
@@ -60,11 +60,14 @@ VkDebugUtilsMessageTypeFlagsEXT message_type, const VkDebugUtilsMessengerCallbac
     return VK_FALSE;
 }
 
+//the highest version the engine asks the instance for, device features past it can't be enabled
+inline constexpr uint32_t ENGINE_API_VERSION = VK_API_VERSION_1_2;
+
 inline VkApplicationInfo get_app_info(const char* app_name = "No Name")
 {
     VkApplicationInfo app_info{};
     app_info.sType = VK_STRUCTURE_TYPE_APPLICATION_INFO;
-    app_info.apiVersion = VK_API_VERSION_1_0;
+    app_info.apiVersion = ENGINE_API_VERSION;
     app_info.engineVersion = VK_MAKE_VERSION(1.0, 0.0, 0.0);
     app_info.applicationVersion = VK_MAKE_VERSION(1.0, 0.0, 0.0);
     app_info.pApplicationName = app_name;